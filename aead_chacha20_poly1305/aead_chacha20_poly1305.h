@@ -6,6 +6,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <algorithm>
+#include <utility>
 
 #include "../chacha20/chacha20.h"
 #include "../poly1305/poly1305.h"
@@ -24,41 +26,101 @@ namespace aead_chacha20_poly1305
         } message_length;
     };
 
+    // private impl
+    namespace impl
+    {
+        static inline aead_chacha20_poly1305_context prepare_aead_context(const void* aad_data, size_t aad_length, const chacha20::context_t& chacha20_context)
+        {
+            std::array<std::byte, 16> empty{};
+            aead_chacha20_poly1305_context context{};
+            struct
+            {
+                poly1305::key_r r;
+                poly1305::key_s s;
+            } poly1305_key_pair;
+
+            context.chacha20_context = chacha20_context;
+            generate_keystream(context.chacha20_context, &poly1305_key_pair, 0, sizeof(poly1305_key_pair));
+            context.poly1305_tag_context = poly1305::prepare_poly1305_tag_context(&poly1305_key_pair.r, &poly1305_key_pair.s);
+
+            process_bytes(context.poly1305_tag_context, aad_data, aad_length);
+            process_bytes(context.poly1305_tag_context, empty.data(), /* pad length */ (-static_cast<int>(aad_length) & 15));
+            context.message_length.aad_length = aad_length;
+
+            return context;
+        }
+    }
+
     static inline aead_chacha20_poly1305_context prepare_aead_chacha20_poly1305_context(const void* aad_data, size_t aad_length, const chacha20::key* key, const chacha20::nonce* nonce)
     {
-        std::array<std::byte, 16> empty{};
-        aead_chacha20_poly1305_context context{};
-        struct
+        return impl::prepare_aead_context(aad_data, aad_length, chacha20::prepare_context(key, nonce));
+    }
+
+    // XChaCha20-Poly1305 (24-byte nonce). encrypt_bytes/decrypt_bytes/finalize_and_calculate_tag are shared.
+    static inline aead_chacha20_poly1305_context prepare_aead_xchacha20_poly1305_context(const void* aad_data, size_t aad_length, const chacha20::key* key, const chacha20::xnonce* nonce)
+    {
+        return impl::prepare_aead_context(aad_data, aad_length, chacha20::xchacha20::prepare_context(key, nonce));
+    }
+
+    // encrypt_bytes/decrypt_bytes run ChaCha20 and Poly1305 alternately over tiles of `tile_size` bytes (rounded down to 64 bytes),
+    // so that Poly1305 reads the data while it is still in L1/L2. 0 disables tiling. the overloads without `tile_size` use this.
+    // note: chacha20::non_temporal_threshold() applies to each tile.
+    static constexpr size_t default_tile_size = 32 * 1024;
+
+    // private impl
+    namespace impl
+    {
+        // process_tile(const std::byte* in, std::byte* out, size_t length)
+        // tiles end at stream positions of multiple of tile size, so that ChaCha20 blocks are not split but at both ends.
+        template <class process_tile_function>
+        static inline void for_each_tile(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length, size_t tile_size, process_tile_function&& process_tile)
         {
-            poly1305::key_r r;
-            poly1305::key_s s;
-        } poly1305_key_pair{};
+            const auto in = static_cast<const std::byte*>(input);
+            const auto out = static_cast<std::byte*>(output);
+            const size_t tile = tile_size / 64 * 64;
+            if (tile == 0)
+                return process_tile(in, out, length);
 
-        context.chacha20_context = chacha20::prepare_context(key, nonce);
-        process_stream(context.chacha20_context, &poly1305_key_pair, &poly1305_key_pair, 0, sizeof(poly1305_key_pair));
-        context.poly1305_tag_context = poly1305::prepare_poly1305_tag_context(&poly1305_key_pair.r, &poly1305_key_pair.s);
+            for (size_t done = 0; done < length;)
+            {
+                const uint64_t position = context.message_length.data_length + done;
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(length - done, tile - position % tile));
+                process_tile(in + done, out + done, n);
+                done += n;
+            }
+        }
+    }
 
-        process_bytes(context.poly1305_tag_context, aad_data, aad_length);
-        process_bytes(context.poly1305_tag_context, empty.data(), /* pad length */ (-static_cast<int>(aad_length) & 15));
-        context.message_length.aad_length = aad_length;
+    static inline aead_chacha20_poly1305_context& encrypt_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length, size_t tile_size)
+    {
+        impl::for_each_tile(context, input, output, length, tile_size, [&context](const std::byte* in, std::byte* out, size_t n)
+        {
+            process_stream(context.chacha20_context, in, out, context.message_length.data_length + 64 /* counter = 1 */, n);
+            process_bytes(context.poly1305_tag_context, out, n);
+            context.message_length.data_length += n;
+        });
+        return context;
+    }
 
+    static inline aead_chacha20_poly1305_context& decrypt_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length, size_t tile_size)
+    {
+        impl::for_each_tile(context, input, output, length, tile_size, [&context](const std::byte* in, std::byte* out, size_t n)
+        {
+            process_bytes(context.poly1305_tag_context, in, n);
+            process_stream(context.chacha20_context, in, out, context.message_length.data_length + 64 /* counter = 1 */, n);
+            context.message_length.data_length += n;
+        });
         return context;
     }
 
     static inline aead_chacha20_poly1305_context& encrypt_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length)
     {
-        process_stream(context.chacha20_context, input, output, context.message_length.data_length + 64 /* counter = 1 */, length);
-        process_bytes(context.poly1305_tag_context, output, length);
-        context.message_length.data_length += length;
-        return context;
+        return encrypt_bytes(context, input, output, length, default_tile_size);
     }
 
     static inline aead_chacha20_poly1305_context& decrypt_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length)
     {
-        process_bytes(context.poly1305_tag_context, input, length);
-        process_stream(context.chacha20_context, input, output, context.message_length.data_length + 64 /* counter = 1 */, length);
-        context.message_length.data_length += length;
-        return context;
+        return decrypt_bytes(context, input, output, length, default_tile_size);
     }
 
     static inline poly1305::mac finalize_and_calculate_tag(aead_chacha20_poly1305_context& context)
@@ -71,3 +133,138 @@ namespace aead_chacha20_poly1305
         return result;
     }
 }
+
+#if defined(ARKANA_POLY1305_X64_BMI2_AVAILABLE)
+#define ARKANA_AEAD_CHACHA20_POLY1305_STITCHED_AVAILABLE 1
+ARKANA_TARGET_REGION_BEGIN("avx2,bmi2,adx")
+namespace aead_chacha20_poly1305
+{
+    // private impl
+    namespace avx2_bmi2::impl
+    {
+        namespace chacha = chacha20::avx2::impl;
+        using poly1305::x64::impl::uint128_t;
+        using poly1305::x64::impl::uint130_t;
+
+        // stitched kernels run in 512-byte steps: 8 ChaCha20 blocks and 32 Poly1305 blocks.
+        static constexpr size_t step_size = 512;
+
+        // inputs shorter than this are processed by the two-pass kernels.
+        static constexpr size_t threshold = 1024;
+
+        static ARKANA_FORCEINLINE void absorb_block(uint130_t& h, const std::byte* message, const uint128_t& r, uint64_t r1_5_4) noexcept
+        {
+            poly1305::x64::impl::process_chunk_bmi2(h, arkintr::load_u<uint128_t>(message), 1, r, r1_5_4);
+        }
+
+        // a double round of 8 ChaCha20 blocks in vertical layout, with 4 Poly1305 blocks (64 bytes of message) interleaved.
+        ARKXMM_API double_round_stitched(chacha::chacha_state8x_vertical& w, uint130_t& h, const std::byte* message, const uint128_t& r, uint64_t r1_5_4) noexcept
+        {
+            chacha::quarter_round(w[0], w[4], w[8], w[12]);
+            chacha::quarter_round(w[1], w[5], w[9], w[13]);
+            absorb_block(h, message + 0, r, r1_5_4);
+            chacha::quarter_round(w[2], w[6], w[10], w[14]);
+            chacha::quarter_round(w[3], w[7], w[11], w[15]);
+            absorb_block(h, message + 16, r, r1_5_4);
+            chacha::quarter_round(w[0], w[5], w[10], w[15]);
+            chacha::quarter_round(w[1], w[6], w[11], w[12]);
+            absorb_block(h, message + 32, r, r1_5_4);
+            chacha::quarter_round(w[2], w[7], w[8], w[13]);
+            chacha::quarter_round(w[3], w[4], w[9], w[14]);
+            absorb_block(h, message + 48, r, r1_5_4);
+        }
+
+        // 8 ChaCha20 blocks (512 bytes) on vector ALUs, and Poly1305 over 512 bytes of `message` on scalar ALUs,
+        // interleaved into the first 8 of 10 double rounds, so that both run at once.
+        // message is read before output is written. (message may be input)
+        template <size_t... j>
+        ARKXMM_API process_step(const chacha20::context_t& ctx, chacha20::counter_t first_block, const std::byte* input, std::byte* output,
+                                uint130_t& h, const std::byte* message, const uint128_t& r, uint64_t r1_5_4, std::index_sequence<j...>) noexcept
+        {
+            chacha::chacha_state8x_vertical w = chacha::load_state8x_vertical(ctx, first_block);
+            const auto init_w12 = w[12], init_w13 = w[13];
+
+            (double_round_stitched(w, h, message + 64 * j, r, r1_5_4), ...);
+            chacha::chacha_rounds_vertical<4>(w);
+
+            chacha::store_state8x_vertical<true, false>(ctx, w, init_w12, init_w13, input, output);
+        }
+
+        ARKXMM_API process_step(const chacha20::context_t& ctx, chacha20::counter_t first_block, const std::byte* input, std::byte* output,
+                                uint130_t& h, const std::byte* message, const uint128_t& r, uint64_t r1_5_4) noexcept
+        {
+            return process_step(ctx, first_block, input, output, h, message, r, r1_5_4, std::make_index_sequence<8>{});
+        }
+
+        // steps over whole 512-byte steps. (the stream position and the tag input are at block boundaries)
+        // encryption hashes the previous step's output while it generates the next one.
+        template <bool encrypt>
+        static inline void process_steps(aead_chacha20_poly1305_context& context, const std::byte* input, std::byte* output, size_t length) noexcept
+        {
+            const auto& ctx = context.chacha20_context;
+            auto& tag = context.poly1305_tag_context;
+            auto h = tag.h;
+            const auto r = tag.r;
+            const auto r1_5_4 = tag.r1_5_4;
+            const auto first_block = static_cast<chacha20::counter_t>((context.message_length.data_length + 64 /* counter = 1 */) / 64);
+
+            if constexpr (encrypt)
+            {
+                chacha::process_block_vertical<20, chacha20::counter_t, true>(ctx, first_block, reinterpret_cast<const chacha::block_t*>(input), reinterpret_cast<chacha::block_t*>(output));
+                for (size_t i = step_size; i < length; i += step_size)
+                    process_step(ctx, static_cast<chacha20::counter_t>(first_block + i / 64), input + i, output + i, h, output + i - step_size, r, r1_5_4);
+                for (size_t i = length - step_size; i < length; i += 16)
+                    absorb_block(h, output + i, r, r1_5_4);
+            }
+            else
+            {
+                for (size_t i = 0; i < length; i += step_size)
+                    process_step(ctx, static_cast<chacha20::counter_t>(first_block + i / 64), input + i, output + i, h, input + i, r, r1_5_4);
+            }
+
+            tag.h = h;
+            tag.input.total_input_byte_count += length;
+            context.message_length.data_length += length;
+        }
+
+        template <bool encrypt>
+        static inline aead_chacha20_poly1305_context& process_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length)
+        {
+            using process_bytes_function = aead_chacha20_poly1305_context& (aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length);
+            constexpr auto process_two_pass = encrypt ? static_cast<process_bytes_function*>(aead_chacha20_poly1305::encrypt_bytes) : static_cast<process_bytes_function*>(aead_chacha20_poly1305::decrypt_bytes);
+            if (length < threshold)
+                return process_two_pass(context, input, output, length);
+
+            // head: up to a ChaCha20 block boundary. (also a Poly1305 block boundary)
+            auto in = static_cast<const std::byte*>(input);
+            auto out = static_cast<std::byte*>(output);
+            const size_t head = static_cast<size_t>(-context.message_length.data_length % 64);
+            process_two_pass(context, in, out, head);
+            in += head;
+            out += head;
+            length -= head;
+
+            const size_t body = length / step_size * step_size;
+            if (body) process_steps<encrypt>(context, in, out, body);
+            in += body;
+            out += body;
+            length -= body;
+
+            return process_two_pass(context, in, out, length);
+        }
+
+        // stitched encrypt_bytes/decrypt_bytes. not dispatched: no faster than the two-pass ones on the CPUs measured so far
+        // (the two-pass ones can use AVX-512 ChaCha20 and the tiling), kept for benchmarking on other cores.
+        static inline aead_chacha20_poly1305_context& encrypt_bytes_stitched(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length)
+        {
+            return process_bytes<true>(context, input, output, length);
+        }
+
+        static inline aead_chacha20_poly1305_context& decrypt_bytes_stitched(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length)
+        {
+            return process_bytes<false>(context, input, output, length);
+        }
+    }
+}
+ARKANA_TARGET_REGION_END()
+#endif
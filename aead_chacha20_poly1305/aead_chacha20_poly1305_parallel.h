@@ -0,0 +1,77 @@
+/// @file
+/// @brief  aead_chacha20_poly1305_parallel.h - multi-threaded encrypt_bytes/decrypt_bytes for long messages
+/// @author (c) 2023 ttsuki
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "../poly1305/poly1305_parallel.h"
+#include "./aead_chacha20_poly1305.h"
+
+namespace aead_chacha20_poly1305::parallel
+{
+    using arkana::parallel::thread_pool;
+
+    // each slice is encrypted and hashed (or hashed and decrypted) by one pool thread while it is hot in cache,
+    // then the slice hashes are combined into the tag context. (see poly1305::parallel)
+
+    // private impl
+    namespace impl
+    {
+        using process_bytes_function = aead_chacha20_poly1305_context& (aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length);
+
+        // process_slice(const std::byte* in, std::byte* out, chacha20::position_t position, size_t length): processes a slice of whole blocks and returns its poly1305 hash.
+        template <class process_slice_function>
+        static inline aead_chacha20_poly1305_context& process_bytes(process_bytes_function* process_serial, process_slice_function&& process_slice,
+                                                                    aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length, thread_pool& pool)
+        {
+            if (length < poly1305::parallel::parallel_threshold || pool.thread_count() == 0)
+                return process_serial(context, input, output, length);
+
+            auto in = static_cast<const std::byte*>(input);
+            auto out = static_cast<std::byte*>(output);
+
+            // head: up to a ChaCha20 block boundary (also a Poly1305 block boundary), so slices begin at block boundaries of both.
+            const size_t head = static_cast<size_t>(std::min<uint64_t>(length, -context.message_length.data_length % 64));
+            process_serial(context, in, out, head);
+            in += head;
+            out += head;
+            length -= head;
+
+            const size_t body = length / 16 * 16;
+            const chacha20::position_t position = context.message_length.data_length + 64 /* counter = 1 */;
+            poly1305::parallel::impl::for_each_slice(pool, context.poly1305_tag_context, body, [&](size_t offset, size_t slice_length)
+            {
+                return process_slice(in + offset, out + offset, position + offset, slice_length);
+            });
+            context.message_length.data_length += body;
+            in += body;
+            out += body;
+            length -= body;
+
+            return process_serial(context, in, out, length);
+        }
+    }
+
+    static inline aead_chacha20_poly1305_context& encrypt_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length, thread_pool& pool = thread_pool::shared())
+    {
+        return impl::process_bytes(aead_chacha20_poly1305::encrypt_bytes, [&context](const std::byte* in, std::byte* out, chacha20::position_t position, size_t slice_length)
+        {
+            process_stream(context.chacha20_context, in, out, position, slice_length);
+            return poly1305::parallel::impl::hash_slice(context.poly1305_tag_context, out, slice_length);
+        }, context, input, output, length, pool);
+    }
+
+    static inline aead_chacha20_poly1305_context& decrypt_bytes(aead_chacha20_poly1305_context& context, const void* input, void* output, size_t length, thread_pool& pool = thread_pool::shared())
+    {
+        return impl::process_bytes(aead_chacha20_poly1305::decrypt_bytes, [&context](const std::byte* in, std::byte* out, chacha20::position_t position, size_t slice_length)
+        {
+            const auto h = poly1305::parallel::impl::hash_slice(context.poly1305_tag_context, in, slice_length);
+            process_stream(context.chacha20_context, in, out, position, slice_length);
+            return h;
+        }, context, input, output, length, pool);
+    }
+}
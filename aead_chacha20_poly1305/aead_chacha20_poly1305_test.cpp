@@ -11,6 +11,7 @@
 #include "../chacha20/chacha20.h"
 #include "../poly1305/poly1305.h"
 #include "./aead_chacha20_poly1305.h"
+#include "./aead_chacha20_poly1305_parallel.h"
 
 int main()
 {
@@ -112,6 +113,56 @@ int main()
             },
             /* Tag: */ {0xee, 0xad, 0x9d, 0x67, 0x89, 0x0c, 0xbb, 0x22, 0x39, 0x23, 0x36, 0xfe, 0xa1, 0x85, 0x1f, 0x38}
         },
+        aead_chacha20_poly1305_test{
+            "Example and Test Vector for AEAD_XCHACHA20_POLY1305 (draft-irtf-cfrg-xchacha A.3.1):",
+            // ==============
+            /* Plaintext: */ {
+                /* 000 */ 0x4c, 0x61, 0x64, 0x69, 0x65, 0x73, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x47, 0x65, 0x6e, 0x74, 0x6c, //  Ladies and Gentl
+                /* 016 */ 0x65, 0x6d, 0x65, 0x6e, 0x20, 0x6f, 0x66, 0x20, 0x74, 0x68, 0x65, 0x20, 0x63, 0x6c, 0x61, 0x73, //  emen of the clas
+                /* 032 */ 0x73, 0x20, 0x6f, 0x66, 0x20, 0x27, 0x39, 0x39, 0x3a, 0x20, 0x49, 0x66, 0x20, 0x49, 0x20, 0x63, //  s of '99: If I c
+                /* 048 */ 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x6f, 0x66, 0x66, 0x65, 0x72, 0x20, 0x79, 0x6f, 0x75, 0x20, 0x6f, //  ould offer you o
+                /* 064 */ 0x6e, 0x6c, 0x79, 0x20, 0x6f, 0x6e, 0x65, 0x20, 0x74, 0x69, 0x70, 0x20, 0x66, 0x6f, 0x72, 0x20, //  nly one tip for 
+                /* 080 */ 0x74, 0x68, 0x65, 0x20, 0x66, 0x75, 0x74, 0x75, 0x72, 0x65, 0x2c, 0x20, 0x73, 0x75, 0x6e, 0x73, //  the future, suns
+                /* 096 */ 0x63, 0x72, 0x65, 0x65, 0x6e, 0x20, 0x77, 0x6f, 0x75, 0x6c, 0x64, 0x20, 0x62, 0x65, 0x20, 0x69, //  creen would be i
+                /* 112 */ 0x74, 0x2e,                                                                                     //  t.
+            },
+            /* AAD: */ {
+                /* 000 */ 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, //  PQRS........
+            },
+            /* Key: */ {
+                /* 000 */ 0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f, //  ................
+                /* 016 */ 0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f, //  ................
+            },
+            /* IV: */ {
+                /* 000 */ 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f, //  @ABCDEFGHIJKLMNO
+                /* 016 */ 0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57,                                                 //  PQRSTUVW
+            },
+            /* Ciphertext: */ {
+                /* 000 */ 0xbd, 0x6d, 0x17, 0x9d, 0x3e, 0x83, 0xd4, 0x3b, 0x95, 0x76, 0x57, 0x94, 0x93, 0xc0, 0xe9, 0x39, //  .m..>..;.vW....9
+                /* 016 */ 0x57, 0x2a, 0x17, 0x00, 0x25, 0x2b, 0xfa, 0xcc, 0xbe, 0xd2, 0x90, 0x2c, 0x21, 0x39, 0x6c, 0xbb, //  W*..%+.....,!9l.
+                /* 032 */ 0x73, 0x1c, 0x7f, 0x1b, 0x0b, 0x4a, 0xa6, 0x44, 0x0b, 0xf3, 0xa8, 0x2f, 0x4e, 0xda, 0x7e, 0x39, //  s....J.D.../N.~9
+                /* 048 */ 0xae, 0x64, 0xc6, 0x70, 0x8c, 0x54, 0xc2, 0x16, 0xcb, 0x96, 0xb7, 0x2e, 0x12, 0x13, 0xb4, 0x52, //  .d.p.T.........R
+                /* 064 */ 0x2f, 0x8c, 0x9b, 0xa4, 0x0d, 0xb5, 0xd9, 0x45, 0xb1, 0x1b, 0x69, 0xb9, 0x82, 0xc1, 0xbb, 0x9e, //  /......E..i.....
+                /* 080 */ 0x3f, 0x3f, 0xac, 0x2b, 0xc3, 0x69, 0x48, 0x8f, 0x76, 0xb2, 0x38, 0x35, 0x65, 0xd3, 0xff, 0xf9, //  ??.+.iH.v.85e...
+                /* 096 */ 0x21, 0xf9, 0x66, 0x4c, 0x97, 0x63, 0x7d, 0xa9, 0x76, 0x88, 0x12, 0xf6, 0x15, 0xc6, 0x8b, 0x13, //  !.fL.c}.v.......
+                /* 112 */ 0xb5, 0x2e,                                                                                     //  ..
+            },
+            /* Tag: */ {0xc0, 0x87, 0x59, 0x24, 0xc1, 0xc7, 0x98, 0x79, 0x47, 0xde, 0xaf, 0xd8, 0x78, 0x0a, 0xcf, 0x49}
+        },
+    };
+
+    const auto prepare_context = [](const aead_chacha20_poly1305_test& tv)
+    {
+        if (tv.nonce.size() == sizeof(chacha20::xnonce))
+            return aead_chacha20_poly1305::prepare_aead_xchacha20_poly1305_context(
+                tv.aad.data(), tv.aad.size(),
+                reinterpret_cast<const chacha20::key*>(tv.key.data()),
+                reinterpret_cast<const chacha20::xnonce*>(tv.nonce.data()));
+
+        return aead_chacha20_poly1305::prepare_aead_chacha20_poly1305_context(
+            tv.aad.data(), tv.aad.size(),
+            reinterpret_cast<const chacha20::key*>(tv.key.data()),
+            reinterpret_cast<const chacha20::nonce*>(tv.nonce.data()));
     };
 
     bool all_test_is_passed = true;
@@ -120,10 +171,7 @@ int main()
         // encrypt
         {
             auto buffer = std::vector<unsigned char>(tv.cipher_text.size(), 0);
-            auto context = aead_chacha20_poly1305::prepare_aead_chacha20_poly1305_context(
-                tv.aad.data(), tv.aad.size(),
-                reinterpret_cast<const chacha20::key*>(tv.key.data()),
-                reinterpret_cast<const chacha20::nonce*>(tv.nonce.data()));
+            auto context = prepare_context(tv);
             aead_chacha20_poly1305::encrypt_bytes(context, tv.plain_text.data(), buffer.data(), buffer.size());
             auto tag = aead_chacha20_poly1305::finalize_and_calculate_tag(context);
 
@@ -143,10 +191,7 @@ int main()
         // decrypt
         {
             auto buffer = std::vector<unsigned char>(tv.plain_text.size(), 0);
-            auto context = aead_chacha20_poly1305::prepare_aead_chacha20_poly1305_context(
-                tv.aad.data(), tv.aad.size(),
-                reinterpret_cast<const chacha20::key*>(tv.key.data()),
-                reinterpret_cast<const chacha20::nonce*>(tv.nonce.data()));
+            auto context = prepare_context(tv);
             aead_chacha20_poly1305::decrypt_bytes(context, tv.cipher_text.data(), buffer.data(), buffer.size());
             auto tag = aead_chacha20_poly1305::finalize_and_calculate_tag(context);
 
@@ -164,5 +209,69 @@ int main()
         }
     }
 
+    // encrypt/decrypt variants: `head` bytes by encrypt_bytes/decrypt_bytes, then `length` bytes by the variant,
+    // give the same cipher text and tag as untiled encrypt_bytes over all of them. (decrypts in place)
+    {
+        chacha20::key key{};
+        chacha20::nonce nonce{};
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<uint8_t>(i * 3 + 7);
+        const std::vector<uint8_t> aad = {1, 2, 3, 4, 5};
+
+        auto plain_text = std::vector<uint8_t>(3 * 1024 * 1024 + 100);
+        for (size_t i = 0; i < plain_text.size(); i++) plain_text[i] = static_cast<uint8_t>(i * 31 + 3);
+
+        const auto check = [&](const std::string& name, auto&& encrypt_variant, auto&& decrypt_variant, size_t head, size_t length)
+        {
+            auto expected = std::vector<uint8_t>(head + length);
+            auto context = aead_chacha20_poly1305::prepare_aead_chacha20_poly1305_context(aad.data(), aad.size(), &key, &nonce);
+            aead_chacha20_poly1305::encrypt_bytes(context, plain_text.data(), expected.data(), expected.size(), /* untiled */ 0);
+            const auto expected_tag = aead_chacha20_poly1305::finalize_and_calculate_tag(context);
+
+            auto cipher_text = std::vector<uint8_t>(head + length);
+            context = aead_chacha20_poly1305::prepare_aead_chacha20_poly1305_context(aad.data(), aad.size(), &key, &nonce);
+            aead_chacha20_poly1305::encrypt_bytes(context, plain_text.data(), cipher_text.data(), head);
+            encrypt_variant(context, plain_text.data() + head, cipher_text.data() + head, length);
+            if (cipher_text != expected || aead_chacha20_poly1305::finalize_and_calculate_tag(context) != expected_tag)
+            {
+                std::cerr << "TEST Encrypt [" << name << ", head " << head << ", length " << length << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+
+            auto decrypted = cipher_text;
+            context = aead_chacha20_poly1305::prepare_aead_chacha20_poly1305_context(aad.data(), aad.size(), &key, &nonce);
+            aead_chacha20_poly1305::decrypt_bytes(context, decrypted.data(), decrypted.data(), head);
+            decrypt_variant(context, decrypted.data() + head, decrypted.data() + head, length);
+            if (!std::equal(decrypted.begin(), decrypted.end(), plain_text.begin()) || aead_chacha20_poly1305::finalize_and_calculate_tag(context) != expected_tag)
+            {
+                std::cerr << "TEST Decrypt [" << name << ", head " << head << ", length " << length << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        };
+
+        // parallel: after unaligned head.
+        aead_chacha20_poly1305::parallel::thread_pool pool{3};
+        const auto encrypt_parallel = [&pool](auto& context, const void* input, void* output, size_t length) { return aead_chacha20_poly1305::parallel::encrypt_bytes(context, input, output, length, pool); };
+        const auto decrypt_parallel = [&pool](auto& context, const void* input, void* output, size_t length) { return aead_chacha20_poly1305::parallel::decrypt_bytes(context, input, output, length, pool); };
+        for (size_t head : {size_t{0}, size_t{7}})
+            check("parallel", encrypt_parallel, decrypt_parallel, head, plain_text.size() - head);
+
+#if defined(ARKANA_AEAD_CHACHA20_POLY1305_STITCHED_AVAILABLE)
+        // stitched: from any stream position.
+        if (const auto& cpu = arkana::cpu_features::get(); cpu.avx2 && cpu.bmi2 && cpu.adx)
+            for (size_t head : {size_t{0}, size_t{7}, size_t{64}})
+                for (size_t length : {size_t{1000}, size_t{1024}, size_t{1500}, size_t{4096 + 37}, size_t{65536}})
+                    check("stitched", aead_chacha20_poly1305::avx2_bmi2::impl::encrypt_bytes_stitched, aead_chacha20_poly1305::avx2_bmi2::impl::decrypt_bytes_stitched, head, length);
+#endif
+
+        // tiled: for any tile size and stream position.
+        for (size_t tile : {size_t{64}, size_t{1000}, size_t{16 * 1024}, aead_chacha20_poly1305::default_tile_size})
+        {
+            const auto encrypt_tiled = [tile](auto& context, const void* input, void* output, size_t length) { return aead_chacha20_poly1305::encrypt_bytes(context, input, output, length, tile); };
+            const auto decrypt_tiled = [tile](auto& context, const void* input, void* output, size_t length) { return aead_chacha20_poly1305::decrypt_bytes(context, input, output, length, tile); };
+            for (size_t head : {size_t{0}, size_t{7}, size_t{12345}})
+                check("tile " + std::to_string(tile), encrypt_tiled, decrypt_tiled, head, 200000 - head);
+        }
+    }
+
     return all_test_is_passed ? 0 : 1;
 }
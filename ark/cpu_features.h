@@ -0,0 +1,112 @@
+/// @file
+/// @brief	arkana::cpu_features - runtime CPU feature detection
+/// @author Copyright(c) 2023 ttsuki
+///
+/// This software is released under the MIT License.
+/// https://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define ARKANA_CPU_FEATURES_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#define ARKANA_PRAGMA(...) _Pragma(#__VA_ARGS__)
+
+// Compiles functions defined between ARKANA_TARGET_REGION_BEGIN("isa") and ARKANA_TARGET_REGION_END() for the target ISA.
+// Standard headers must be included outside of the region.
+#if defined(__clang__)
+#define ARKANA_TARGET_REGION_BEGIN(isa) ARKANA_PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+#define ARKANA_TARGET_REGION_END() ARKANA_PRAGMA(clang attribute pop)
+#elif defined(__GNUC__)
+#define ARKANA_TARGET_REGION_BEGIN(isa) ARKANA_PRAGMA(GCC push_options) ARKANA_PRAGMA(GCC target(isa))
+#define ARKANA_TARGET_REGION_END() ARKANA_PRAGMA(GCC pop_options)
+#else // MSVC: any intrinsic is available without target attributes.
+#define ARKANA_TARGET_REGION_BEGIN(isa)
+#define ARKANA_TARGET_REGION_END()
+#endif
+
+namespace arkana::cpu_features
+{
+    struct features
+    {
+        bool sse2;
+        bool ssse3;
+        bool sse41;
+        bool avx;
+        bool avx2;
+        bool bmi2;
+        bool adx;
+        bool avx512f;
+        bool avx512vl;
+    };
+
+    inline features detect() noexcept
+    {
+        features f{};
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+        const auto cpuid = [](uint32_t leaf, uint32_t sub_leaf) -> std::array<uint32_t, 4>
+        {
+#if defined(_MSC_VER)
+            int r[4]{};
+            ::__cpuidex(r, static_cast<int>(leaf), static_cast<int>(sub_leaf));
+            return {static_cast<uint32_t>(r[0]), static_cast<uint32_t>(r[1]), static_cast<uint32_t>(r[2]), static_cast<uint32_t>(r[3])};
+#else
+            unsigned int r[4]{};
+            __cpuid_count(leaf, sub_leaf, r[0], r[1], r[2], r[3]);
+            return {r[0], r[1], r[2], r[3]};
+#endif
+        };
+
+        const auto xgetbv = []() -> uint64_t
+        {
+#if defined(_MSC_VER)
+            return ::_xgetbv(0);
+#else
+            uint32_t eax, edx;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+            return static_cast<uint64_t>(edx) << 32 | eax;
+#endif
+        };
+
+        const auto bit = [](uint32_t reg, int i) { return (reg >> i & 1) != 0; };
+
+        const auto leaf0 = cpuid(0, 0);
+        const auto leaf1 = cpuid(1, 0);
+        const auto leaf7 = leaf0[0] >= 7 ? cpuid(7, 0) : std::array<uint32_t, 4>{};
+
+        // OS saves XMM/YMM (and opmask/ZMM) registers on context switch.
+        const uint64_t xcr0 = bit(leaf1[2], 27) /* OSXSAVE */ ? xgetbv() : 0;
+        const bool os_avx = (xcr0 & 0x06) == 0x06;
+        const bool os_avx512 = (xcr0 & 0xE6) == 0xE6;
+
+        f.sse2 = bit(leaf1[3], 26);
+        f.ssse3 = bit(leaf1[2], 9);
+        f.sse41 = bit(leaf1[2], 19);
+        f.avx = bit(leaf1[2], 28) && os_avx;
+        f.avx2 = bit(leaf7[1], 5) && f.avx;
+        f.bmi2 = bit(leaf7[1], 8);
+        f.adx = bit(leaf7[1], 19);
+        f.avx512f = bit(leaf7[1], 16) && f.avx2 && os_avx512;
+        f.avx512vl = bit(leaf7[1], 31) && f.avx512f;
+#endif
+
+        return f;
+    }
+
+    /// Gets features of running CPU. (detected once)
+    inline const features& get() noexcept
+    {
+        static const features f = detect();
+        return f;
+    }
+}
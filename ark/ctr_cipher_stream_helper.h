@@ -9,15 +9,20 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <algorithm>
 #include <type_traits>
 
 namespace arkana::ctr_cipher_stream_helper
 {
-    template <class block_t, class counter_t = uint32_t, class stream_position_t = uint64_t, class context_t, class process_blocks_function>
+    // Callbacks process_blocks with whole blocks, and process_partial with a head or tail shorter than a block.
+    template <class block_t, class counter_t, class stream_position_t = uint64_t, class context_t, class process_blocks_function, class process_partial_function>
     static inline void process_stream_with_ctr(
         // process_blocks(context_t& ctx, const block_t* input, block_t* output, counter_t counter, size_t count)
         process_blocks_function&& process_blocks,
+        // process_partial(context_t& ctx, stream_position_t position, const std::byte* input, std::byte* output, size_t length)
+        //   processes bytes [position, position + length) that lie in one block.
+        process_partial_function&& process_partial,
         context_t& ctx,
         const std::byte* input,
         std::byte* output,
@@ -27,18 +32,12 @@ namespace arkana::ctr_cipher_stream_helper
         constexpr size_t block_size = sizeof(block_t);
         static_assert(std::is_trivial_v<block_t>);
 
-        // calculates first block index.
-        counter_t block_index = static_cast<counter_t>(position / block_size);
-
         if (size_t offset = static_cast<size_t>(position % block_size))
         {
             size_t len = std::min<size_t>(length, block_size - offset);
 
             // processes partial block.
-            block_t b{};
-            std::memcpy(reinterpret_cast<std::byte*>(&b) + offset, input, len);
-            process_blocks(ctx, &b, &b, block_index++, 1);
-            std::memcpy(output, reinterpret_cast<std::byte*>(&b) + offset, len);
+            process_partial(ctx, position, input, output, len);
 
             // advances pointers.
             position += static_cast<stream_position_t>(len);
@@ -47,6 +46,9 @@ namespace arkana::ctr_cipher_stream_helper
             length -= len;
         }
 
+        // calculates first block index.
+        counter_t block_index = static_cast<counter_t>(position / block_size);
+
         if (size_t block_count = length / block_size)
         {
             // processes blocks.
@@ -63,10 +65,7 @@ namespace arkana::ctr_cipher_stream_helper
         if (size_t len = length)
         {
             // processes partial block.
-            block_t b{};
-            std::memcpy(reinterpret_cast<std::byte*>(&b), input, len);
-            process_blocks(ctx, &b, &b, block_index++, 1);
-            std::memcpy(output, reinterpret_cast<std::byte*>(&b), len);
+            process_partial(ctx, position, input, output, len);
 
             // advances pointers.
             position += static_cast<stream_position_t>(len);
@@ -75,4 +74,29 @@ namespace arkana::ctr_cipher_stream_helper
             length -= len;
         }
     }
+
+    template <class block_t, class counter_t, class stream_position_t = uint64_t, class context_t, class process_blocks_function>
+    static inline void process_stream_with_ctr(
+        // process_blocks(context_t& ctx, const block_t* input, block_t* output, counter_t counter, size_t count)
+        process_blocks_function&& process_blocks,
+        context_t& ctx,
+        const std::byte* input,
+        std::byte* output,
+        stream_position_t position,
+        size_t length)
+    {
+        constexpr size_t block_size = sizeof(block_t);
+        return process_stream_with_ctr<block_t, counter_t, stream_position_t>(
+            process_blocks,
+            [&process_blocks](context_t& ctx, stream_position_t position, const std::byte* input, std::byte* output, size_t length)
+            {
+                // processes partial block through bounce buffer.
+                size_t offset = static_cast<size_t>(position % block_size);
+                block_t b{};
+                std::memcpy(reinterpret_cast<std::byte*>(&b) + offset, input, length);
+                process_blocks(ctx, &b, &b, static_cast<counter_t>(position / block_size), 1);
+                std::memcpy(output, reinterpret_cast<std::byte*>(&b) + offset, length);
+            },
+            ctx, input, output, position, length);
+    }
 }
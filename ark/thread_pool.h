@@ -0,0 +1,138 @@
+/// @file
+/// @brief	arkana::parallel::thread_pool - persistent worker threads for data-parallel loops
+/// @author Copyright(c) 2023 ttsuki
+///
+/// This software is released under the MIT License.
+/// https://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <type_traits>
+
+namespace arkana::parallel
+{
+    class thread_pool
+    {
+    public:
+        // the calling thread of parallel_for also runs tasks, so (thread_count + 1) threads run at once.
+        explicit thread_pool(size_t thread_count = default_thread_count())
+        {
+            workers_.reserve(thread_count);
+            for (size_t i = 0; i < thread_count; i++)
+                workers_.emplace_back([this] { worker(); });
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard lock(mutex_);
+                stopping_ = true;
+            }
+            wake_.notify_all();
+            for (auto& t : workers_) t.join();
+        }
+
+        size_t thread_count() const noexcept { return workers_.size(); }
+
+        // hardware threads but the calling one.
+        static size_t default_thread_count() noexcept
+        {
+            const size_t n = std::thread::hardware_concurrency();
+            return n > 1 ? n - 1 : 0;
+        }
+
+        // process-wide pool. (created on first use)
+        static thread_pool& shared()
+        {
+            static thread_pool pool{};
+            return pool;
+        }
+
+        // runs task(i) for each i in [0, count) and returns when all of them have finished.
+        // task must not throw, nor call parallel_for of the same pool.
+        // calls from several threads are serialized.
+        template <class task_function>
+        void parallel_for(size_t count, task_function&& task)
+        {
+            if (count == 0) return;
+
+            job j{};
+            j.count = count;
+            j.task = const_cast<void*>(static_cast<const void*>(&task));
+            j.invoke = [](void* t, size_t i) { (*static_cast<std::remove_reference_t<task_function>*>(t))(i); };
+
+            std::lock_guard submit(submit_mutex_);
+            if (count > 1 && !workers_.empty())
+            {
+                std::lock_guard lock(mutex_);
+                job_ = &j;
+                generation_++;
+                wake_.notify_all();
+            }
+
+            run(j);
+
+            std::unique_lock lock(mutex_);
+            done_.wait(lock, [&j] { return j.active == 0; });
+            job_ = nullptr;
+        }
+
+    private:
+        struct job
+        {
+            size_t count;
+            void* task;
+            void (*invoke)(void* task, size_t index);
+            std::atomic<size_t> next{0};
+            size_t active = 0; // workers running this job (guarded by mutex_)
+        };
+
+        std::vector<std::thread> workers_;
+        std::mutex submit_mutex_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        job* job_ = nullptr;
+        uint64_t generation_ = 0;
+        bool stopping_ = false;
+
+        static void run(job& j) noexcept
+        {
+            for (size_t i; (i = j.next.fetch_add(1, std::memory_order_relaxed)) < j.count;)
+                j.invoke(j.task, i);
+        }
+
+        void worker() noexcept
+        {
+            uint64_t seen = 0;
+            std::unique_lock lock(mutex_);
+            for (;;)
+            {
+                wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+
+                // the job may have finished before this worker woke up.
+                job* j = job_;
+                if (!j) continue;
+
+                j->active++;
+                lock.unlock();
+                run(*j);
+                lock.lock();
+                if (--j->active == 0)
+                    done_.notify_all();
+            }
+        }
+    };
+}
@@ -5,7 +5,8 @@
 /// This software is released under the MIT License.
 /// https://opensource.org/licenses/MIT
 
-#pragma once
+#ifndef ARKANA_ARK_XMM_PROLOGUE_INCLUDED
+#define ARKANA_ARK_XMM_PROLOGUE_INCLUDED
 
 #include <cstddef>
 #include <cstdint>
@@ -34,8 +35,23 @@
 #define ARKXMM_API  static ARKXMM_INLINE auto ARKXMM_VECTORCALL
 #define ARKXMM_DEFINE_EXTENSION(...) decltype(__VA_ARGS__) { return (__VA_ARGS__); }
 
-namespace arkana::xmm
+#endif
+
+// The wrappers below can be included again into `arkana::ARKXMM_NAMESPACE`
+// to be compiled for another target ISA. (see xmm_targets.h)
+#if defined(ARKXMM_NAMESPACE) || !defined(ARKANA_ARK_XMM_INCLUDED)
+#ifndef ARKXMM_NAMESPACE
+#define ARKANA_ARK_XMM_INCLUDED
+#define ARKXMM_NAMESPACE xmm
+#define ARKXMM_NAMESPACE_IS_DEFAULT
+#endif
+
+namespace arkana::ARKXMM_NAMESPACE
 {
+#ifndef ARKXMM_NAMESPACE_IS_DEFAULT
+    namespace xmm = ::arkana::ARKXMM_NAMESPACE;
+#endif
+
     using std::int8_t;
     using std::int16_t;
     using std::int32_t;
@@ -149,6 +165,54 @@ namespace arkana::xmm
     using vf64x4 = YMM<float64_t>;
     using vx128x2 = YMM<xint128_t>;
 
+    /// AVX-512 __m512i
+    template <class T>
+    struct alignas(64) ZMM
+    {
+        using vector_t = __m512i;
+        using element_t = T;
+        static constexpr inline size_t element_bits = sizeof(element_t) * 8;
+        static constexpr inline size_t size = sizeof(vector_t) / sizeof(element_t);
+        using array_t = std::array<element_t, size>;
+        vector_t v;
+    };
+
+    /// AVX-512 __m512
+    template <>
+    struct alignas(64) ZMM<float32_t>
+    {
+        using vector_t = __m512;
+        using element_t = float32_t;
+        static constexpr inline size_t element_bits = sizeof(element_t) * 8;
+        static constexpr inline size_t size = sizeof(vector_t) / sizeof(element_t);
+        using array_t = std::array<element_t, size>;
+        vector_t v;
+    };
+
+    /// AVX-512 __m512d
+    template <>
+    struct alignas(64) ZMM<float64_t>
+    {
+        using vector_t = __m512d;
+        using element_t = float64_t;
+        static constexpr inline size_t element_bits = sizeof(element_t) * 8;
+        static constexpr inline size_t size = sizeof(vector_t) / sizeof(element_t);
+        using array_t = std::array<element_t, size>;
+        vector_t v;
+    };
+
+    using vi8x64 = ZMM<int8_t>;
+    using vu8x64 = ZMM<uint8_t>;
+    using vi16x32 = ZMM<int16_t>;
+    using vu16x32 = ZMM<uint16_t>;
+    using vi32x16 = ZMM<int32_t>;
+    using vu32x16 = ZMM<uint32_t>;
+    using vf32x16 = ZMM<float32_t>;
+    using vi64x8 = ZMM<int64_t>;
+    using vu64x8 = ZMM<uint64_t>;
+    using vf64x8 = ZMM<float64_t>;
+    using vx128x4 = ZMM<xint128_t>;
+
     struct SHIFT
     {
         int64_t i;
@@ -183,14 +247,23 @@ namespace arkana::xmm
         template <class YMM, class T = YMM> using if_f32x8 = std::enable_if_t<std::is_floating_point_v<typename YMM::element_t> && YMM::element_bits * YMM::size == 256 && YMM::element_bits == 32, T>;
         template <class YMM, class T = YMM> using if_f64x4 = std::enable_if_t<std::is_floating_point_v<typename YMM::element_t> && YMM::element_bits * YMM::size == 256 && YMM::element_bits == 64, T>;
 
-        template <class NMM, class T = NMM> using if_NMM = std::enable_if_t<(NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256), T>;
-        template <class NMM, class T = NMM> using if_iNMM = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256), T>;
-        template <class NMM, class T = NMM> using if_8xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256) && NMM::element_bits == 8, T>;
-        template <class NMM, class T = NMM> using if_16xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256) && NMM::element_bits == 16, T>;
-        template <class NMM, class T = NMM> using if_32xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256) && NMM::element_bits == 32, T>;
-        template <class NMM, class T = NMM> using if_64xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256) && NMM::element_bits == 64, T>;
-        template <class NMM, class T = NMM> using if_f32xN = std::enable_if_t<std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256) && NMM::element_bits == 32, T>;
-        template <class NMM, class T = NMM> using if_f64xN = std::enable_if_t<std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256) && NMM::element_bits == 64, T>;
+        template <class ZMM, class T = ZMM> using if_ZMM = std::enable_if_t<ZMM::element_bits * ZMM::size == 512, T>;
+        template <class ZMM, class T = ZMM> using if_iZMM = std::enable_if_t<!std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512, T>;
+        template <class ZMM, class T = ZMM> using if_8x64 = std::enable_if_t<!std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512 && ZMM::element_bits == 8, T>;
+        template <class ZMM, class T = ZMM> using if_16x32 = std::enable_if_t<!std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512 && ZMM::element_bits == 16, T>;
+        template <class ZMM, class T = ZMM> using if_32x16 = std::enable_if_t<!std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512 && ZMM::element_bits == 32, T>;
+        template <class ZMM, class T = ZMM> using if_64x8 = std::enable_if_t<!std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512 && ZMM::element_bits == 64, T>;
+        template <class ZMM, class T = ZMM> using if_f32x16 = std::enable_if_t<std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512 && ZMM::element_bits == 32, T>;
+        template <class ZMM, class T = ZMM> using if_f64x8 = std::enable_if_t<std::is_floating_point_v<typename ZMM::element_t> && ZMM::element_bits * ZMM::size == 512 && ZMM::element_bits == 64, T>;
+
+        template <class NMM, class T = NMM> using if_NMM = std::enable_if_t<(NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512), T>;
+        template <class NMM, class T = NMM> using if_iNMM = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512), T>;
+        template <class NMM, class T = NMM> using if_8xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512) && NMM::element_bits == 8, T>;
+        template <class NMM, class T = NMM> using if_16xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512) && NMM::element_bits == 16, T>;
+        template <class NMM, class T = NMM> using if_32xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512) && NMM::element_bits == 32, T>;
+        template <class NMM, class T = NMM> using if_64xN = std::enable_if_t<!std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512) && NMM::element_bits == 64, T>;
+        template <class NMM, class T = NMM> using if_f32xN = std::enable_if_t<std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512) && NMM::element_bits == 32, T>;
+        template <class NMM, class T = NMM> using if_f64xN = std::enable_if_t<std::is_floating_point_v<typename NMM::element_t> && (NMM::element_bits * NMM::size == 128 || NMM::element_bits * NMM::size == 256 || NMM::element_bits * NMM::size == 512) && NMM::element_bits == 64, T>;
     }
 
     template <class XMM> ARKXMM_API load_u(const void* src) -> enable::if_iXMM<XMM> { return XMM{_mm_lddqu_si128(&static_cast<const XMM*>(src)->v)}; }                         // SSE3
@@ -211,6 +284,15 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API load_s(const void* src) -> enable::if_iYMM<YMM> { return YMM{_mm256_stream_load_si256(&static_cast<const YMM*>(src)->v)}; }                // AVX2
     template <class YMM> ARKXMM_API load_s(const void* src) -> enable::if_f32x8<YMM> { return YMM{_mm256_load_ps(static_cast<const vf32x4::element_t*>(src))}; }               // AVX
     template <class YMM> ARKXMM_API load_s(const void* src) -> enable::if_f64x4<YMM> { return YMM{_mm256_load_pd(static_cast<const vf64x2::element_t*>(src))}; }               // AVX
+    template <class ZMM> ARKXMM_API load_u(const void* src) -> enable::if_iZMM<ZMM> { return ZMM{_mm512_loadu_si512(&static_cast<const ZMM*>(src)->v)}; }                      // AVX512F
+    template <class ZMM> ARKXMM_API load_u(const void* src) -> enable::if_f32x16<ZMM> { return ZMM{_mm512_loadu_ps(static_cast<const vf32x4::element_t*>(src))}; }             // AVX512F
+    template <class ZMM> ARKXMM_API load_u(const void* src) -> enable::if_f64x8<ZMM> { return ZMM{_mm512_loadu_pd(static_cast<const vf64x2::element_t*>(src))}; }              // AVX512F
+    template <class ZMM> ARKXMM_API load_a(const void* src) -> enable::if_iZMM<ZMM> { return ZMM{_mm512_load_si512(&static_cast<const ZMM*>(src)->v)}; }                       // AVX512F
+    template <class ZMM> ARKXMM_API load_a(const void* src) -> enable::if_f32x16<ZMM> { return ZMM{_mm512_load_ps(static_cast<const vf32x4::element_t*>(src))}; }              // AVX512F
+    template <class ZMM> ARKXMM_API load_a(const void* src) -> enable::if_f64x8<ZMM> { return ZMM{_mm512_load_pd(static_cast<const vf64x2::element_t*>(src))}; }               // AVX512F
+    template <class ZMM> ARKXMM_API load_s(const void* src) -> enable::if_iZMM<ZMM> { return ZMM{_mm512_stream_load_si512(&const_cast<ZMM*>(static_cast<const ZMM*>(src))->v)}; } // AVX512F
+    template <class ZMM> ARKXMM_API load_s(const void* src) -> enable::if_f32x16<ZMM> { return ZMM{_mm512_load_ps(static_cast<const vf32x4::element_t*>(src))}; }              // AVX512F
+    template <class ZMM> ARKXMM_API load_s(const void* src) -> enable::if_f64x8<ZMM> { return ZMM{_mm512_load_pd(static_cast<const vf64x2::element_t*>(src))}; }               // AVX512F
 
     template <class XMM> ARKXMM_API store_u(void* dst, const std::decay_t<XMM> v) -> enable::if_iXMM<XMM> { return _mm_storeu_si128(&static_cast<XMM*>(dst)->v, v.v), v; }            // SSE2
     template <class XMM> ARKXMM_API store_u(void* dst, const std::decay_t<XMM> v) -> enable::if_f32x4<XMM> { return _mm_storeu_ps(static_cast<vf32x4::element_t*>(dst), v.v), v; }    // SSE
@@ -230,6 +312,15 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API store_s(void* dst, const std::decay_t<YMM> v) -> enable::if_iYMM<YMM> { return _mm256_stream_si256(&static_cast<YMM*>(dst)->v, v.v), v; }         // AVX
     template <class YMM> ARKXMM_API store_s(void* dst, const std::decay_t<YMM> v) -> enable::if_f32x8<YMM> { return _mm256_stream_ps(static_cast<vf32x4::element_t*>(dst), v.v), v; } // AVX
     template <class YMM> ARKXMM_API store_s(void* dst, const std::decay_t<YMM> v) -> enable::if_f64x4<YMM> { return _mm256_stream_pd(static_cast<vf64x2::element_t*>(dst), v.v), v; } // AVX
+    template <class ZMM> ARKXMM_API store_u(void* dst, const std::decay_t<ZMM> v) -> enable::if_iZMM<ZMM> { return _mm512_storeu_si512(&static_cast<ZMM*>(dst)->v, v.v), v; }         // AVX512F
+    template <class ZMM> ARKXMM_API store_u(void* dst, const std::decay_t<ZMM> v) -> enable::if_f32x16<ZMM> { return _mm512_storeu_ps(static_cast<vf32x4::element_t*>(dst), v.v), v; } // AVX512F
+    template <class ZMM> ARKXMM_API store_u(void* dst, const std::decay_t<ZMM> v) -> enable::if_f64x8<ZMM> { return _mm512_storeu_pd(static_cast<vf64x2::element_t*>(dst), v.v), v; }  // AVX512F
+    template <class ZMM> ARKXMM_API store_a(void* dst, const std::decay_t<ZMM> v) -> enable::if_iZMM<ZMM> { return _mm512_store_si512(&static_cast<ZMM*>(dst)->v, v.v), v; }          // AVX512F
+    template <class ZMM> ARKXMM_API store_a(void* dst, const std::decay_t<ZMM> v) -> enable::if_f32x16<ZMM> { return _mm512_store_ps(static_cast<vf32x4::element_t*>(dst), v.v), v; }  // AVX512F
+    template <class ZMM> ARKXMM_API store_a(void* dst, const std::decay_t<ZMM> v) -> enable::if_f64x8<ZMM> { return _mm512_store_pd(static_cast<vf64x2::element_t*>(dst), v.v), v; }   // AVX512F
+    template <class ZMM> ARKXMM_API store_s(void* dst, const std::decay_t<ZMM> v) -> enable::if_iZMM<ZMM> { return _mm512_stream_si512(&static_cast<ZMM*>(dst)->v, v.v), v; }         // AVX512F
+    template <class ZMM> ARKXMM_API store_s(void* dst, const std::decay_t<ZMM> v) -> enable::if_f32x16<ZMM> { return _mm512_stream_ps(static_cast<vf32x4::element_t*>(dst), v.v), v; } // AVX512F
+    template <class ZMM> ARKXMM_API store_s(void* dst, const std::decay_t<ZMM> v) -> enable::if_f64x8<ZMM> { return _mm512_stream_pd(static_cast<vf64x2::element_t*>(dst), v.v), v; }  // AVX512F
 
     /// to array
     template <class NMM> ARKXMM_API to_array(NMM v) -> typename NMM::array_t
@@ -241,6 +332,7 @@ namespace arkana::xmm
 
     template <class To, class T> ARKXMM_API reinterpret(XMM<T> v) -> enable::if_iXMM<To> { return To{v.v}; } // cast XMM to another XMM
     template <class To, class T> ARKXMM_API reinterpret(YMM<T> v) -> enable::if_iYMM<To> { return To{v.v}; } // cast YMM to another YMM
+    template <class To, class T> ARKXMM_API reinterpret(ZMM<T> v) -> enable::if_iZMM<To> { return To{v.v}; } // cast ZMM to another ZMM
 
     template <class XMM> ARKXMM_API zero() -> enable::if_iXMM<XMM> { return {_mm_setzero_si128()}; }    // SSE2
     template <class YMM> ARKXMM_API zero() -> enable::if_f32x4<YMM> { return {_mm_setzero_ps()}; }      // SSE
@@ -248,6 +340,9 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API zero() -> enable::if_iYMM<YMM> { return {_mm256_setzero_si256()}; } // AVX
     template <class YMM> ARKXMM_API zero() -> enable::if_f32x8<YMM> { return {_mm256_setzero_ps()}; }   // AVX
     template <class YMM> ARKXMM_API zero() -> enable::if_f64x4<YMM> { return {_mm256_setzero_pd()}; }   // AVX
+    template <class ZMM> ARKXMM_API zero() -> enable::if_iZMM<ZMM> { return {_mm512_setzero_si512()}; } // AVX512F
+    template <class ZMM> ARKXMM_API zero() -> enable::if_f32x16<ZMM> { return {_mm512_setzero_ps()}; }  // AVX512F
+    template <class ZMM> ARKXMM_API zero() -> enable::if_f64x8<ZMM> { return {_mm512_setzero_pd()}; }   // AVX512F
 
     // broadcast - use as `broadcast<vu32x4>(123)`
     template <class XMM> ARKXMM_API broadcast(typename XMM::element_t val) -> enable::if_8x16<XMM> { return {_mm_set1_epi8(static_cast<int8_t>(val))}; }                               // SSE2
@@ -265,6 +360,14 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API broadcast(XMM<typename YMM::element_t> val) -> enable::if_iYMM<YMM> { return {_mm256_insertf128_si256(_mm256_castsi128_si256(val.v), val.v, 1)}; } // AVX2
     template <class YMM> ARKXMM_API broadcast(XMM<typename YMM::element_t> val) -> enable::if_f32x8<YMM> { return {_mm256_insertf128_ps(_mm256_castps128_ps256(val.v), val.v, 1)}; }   // AVX
     template <class YMM> ARKXMM_API broadcast(XMM<typename YMM::element_t> val) -> enable::if_f64x4<YMM> { return {_mm256_insertf128_pd(_mm256_castpd128_pd256(val.v), val.v, 1)}; }   // AVX
+    template <class ZMM> ARKXMM_API broadcast(typename ZMM::element_t val) -> enable::if_8x64<ZMM> { return {_mm512_set1_epi8(static_cast<int8_t>(val))}; }                            // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(typename ZMM::element_t val) -> enable::if_16x32<ZMM> { return {_mm512_set1_epi16(static_cast<int16_t>(val))}; }                         // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(typename ZMM::element_t val) -> enable::if_32x16<ZMM> { return {_mm512_set1_epi32(static_cast<int32_t>(val))}; }                         // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(typename ZMM::element_t val) -> enable::if_64x8<ZMM> { return {_mm512_set1_epi64(static_cast<int64_t>(val))}; }                          // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(typename ZMM::element_t val) -> enable::if_f32x16<ZMM> { return {_mm512_set1_ps(static_cast<float32_t>(val))}; }                         // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(typename ZMM::element_t val) -> enable::if_f64x8<ZMM> { return {_mm512_set1_pd(static_cast<float64_t>(val))}; }                          // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(XMM<typename ZMM::element_t> val) -> enable::if_iZMM<ZMM> { return {_mm512_broadcast_i32x4(val.v)}; }                                   // AVX512F
+    template <class ZMM> ARKXMM_API broadcast(YMM<typename ZMM::element_t> val) -> enable::if_iZMM<ZMM> { return {_mm512_broadcast_i64x4(val.v)}; }                                   // AVX512F
 
     // XMM from_values - use as `from_values<vu32x4>(1, 2, 3, 4)`
     template <class XMM> ARKXMM_API from_values(typename XMM::element_t x0, typename XMM::element_t x1, typename XMM::element_t x2, typename XMM::element_t x3, typename XMM::element_t x4, typename XMM::element_t x5, typename XMM::element_t x6, typename XMM::element_t x7, typename XMM::element_t x8, typename XMM::element_t x9, typename XMM::element_t xA, typename XMM::element_t xB, typename XMM::element_t xC, typename XMM::element_t xD, typename XMM::element_t xE, typename XMM::element_t xF) -> enable::if_8x16<XMM> { return {_mm_setr_epi8(static_cast<int8_t>(x0), static_cast<int8_t>(x1), static_cast<int8_t>(x2), static_cast<int8_t>(x3), static_cast<int8_t>(x4), static_cast<int8_t>(x5), static_cast<int8_t>(x6), static_cast<int8_t>(x7), static_cast<int8_t>(x8), static_cast<int8_t>(x9), static_cast<int8_t>(xA), static_cast<int8_t>(xB), static_cast<int8_t>(xC), static_cast<int8_t>(xD), static_cast<int8_t>(xE), static_cast<int8_t>(xF))}; }
@@ -296,6 +399,17 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API from_values(XMM<typename YMM::element_t> x0) -> enable::if_f32x8<YMM> { return broadcast<YMM>(x0); } // AVX
     template <class YMM> ARKXMM_API from_values(XMM<typename YMM::element_t> x0) -> enable::if_f64x4<YMM> { return broadcast<YMM>(x0); } // AVX
 
+    // ZMM from_values - use as `from_values<vu32x16>(0, 1, 2, ..., 15)`
+    template <class ZMM> ARKXMM_API from_values(typename ZMM::element_t x0, typename ZMM::element_t x1, typename ZMM::element_t x2, typename ZMM::element_t x3, typename ZMM::element_t x4, typename ZMM::element_t x5, typename ZMM::element_t x6, typename ZMM::element_t x7, typename ZMM::element_t x8, typename ZMM::element_t x9, typename ZMM::element_t xA, typename ZMM::element_t xB, typename ZMM::element_t xC, typename ZMM::element_t xD, typename ZMM::element_t xE, typename ZMM::element_t xF) -> enable::if_32x16<ZMM> { return {_mm512_setr_epi32(static_cast<int32_t>(x0), static_cast<int32_t>(x1), static_cast<int32_t>(x2), static_cast<int32_t>(x3), static_cast<int32_t>(x4), static_cast<int32_t>(x5), static_cast<int32_t>(x6), static_cast<int32_t>(x7), static_cast<int32_t>(x8), static_cast<int32_t>(x9), static_cast<int32_t>(xA), static_cast<int32_t>(xB), static_cast<int32_t>(xC), static_cast<int32_t>(xD), static_cast<int32_t>(xE), static_cast<int32_t>(xF))}; }
+    template <class ZMM> ARKXMM_API from_values(typename ZMM::element_t x0, typename ZMM::element_t x1, typename ZMM::element_t x2, typename ZMM::element_t x3, typename ZMM::element_t x4, typename ZMM::element_t x5, typename ZMM::element_t x6, typename ZMM::element_t x7) -> enable::if_64x8<ZMM> { return {_mm512_set_epi64(static_cast<int64_t>(x7), static_cast<int64_t>(x6), static_cast<int64_t>(x5), static_cast<int64_t>(x4), static_cast<int64_t>(x3), static_cast<int64_t>(x2), static_cast<int64_t>(x1), static_cast<int64_t>(x0))}; }
+    template <class ZMM> ARKXMM_API from_values(XMM<typename ZMM::element_t> x0, XMM<typename ZMM::element_t> x1, XMM<typename ZMM::element_t> x2, XMM<typename ZMM::element_t> x3) -> enable::if_iZMM<ZMM> { return {_mm512_inserti32x4(_mm512_inserti32x4(_mm512_inserti32x4(_mm512_castsi128_si512(x0.v), x1.v, 1), x2.v, 2), x3.v, 3)}; }
+    template <class ZMM> ARKXMM_API from_values(YMM<typename ZMM::element_t> x0, YMM<typename ZMM::element_t> x1) -> enable::if_iZMM<ZMM> { return {_mm512_inserti64x4(_mm512_castsi256_si512(x0.v), x1.v, 1)}; }
+
+    // ZMM from_values xmm x4 - use as `from_values<vu32x16>(1, 2, 3, 4)`
+    template <class ZMM> ARKXMM_API from_values(typename ZMM::element_t x0, typename ZMM::element_t x1, typename ZMM::element_t x2, typename ZMM::element_t x3) -> enable::if_32x16<ZMM> { return broadcast<ZMM>(from_values<XMM<typename ZMM::element_t>>(x0, x1, x2, x3)); }
+    template <class ZMM> ARKXMM_API from_values(typename ZMM::element_t x0, typename ZMM::element_t x1) -> enable::if_64x8<ZMM> { return broadcast<ZMM>(from_values<XMM<typename ZMM::element_t>>(x0, x1)); }
+    template <class ZMM> ARKXMM_API from_values(XMM<typename ZMM::element_t> x0) -> enable::if_iZMM<ZMM> { return broadcast<ZMM>(x0); } // AVX512F
+
     // bitwise operators
     template <class XMM> ARKXMM_API operator ~(XMM a) -> enable::if_iXMM<XMM> { return {_mm_xor_si128(a.v, _mm_cmpeq_epi32(a.v, a.v))}; }                 // SSE2
     template <class XMM> ARKXMM_API operator ~(XMM a) -> enable::if_f32x4<XMM> { return {_mm_xor_ps(a.v, _mm_castsi128_ps((~zero<vi32x4>()).v))}; }       // SSE
@@ -303,30 +417,35 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API operator ~(YMM a) -> enable::if_iYMM<YMM> { return {_mm256_xor_si256(a.v, _mm256_cmpeq_epi32(a.v, a.v))}; }           // AVX2
     template <class YMM> ARKXMM_API operator ~(YMM a) -> enable::if_f32x8<YMM> { return {_mm256_xor_ps(a.v, _mm256_castsi256_ps((~zero<vi32x8>()).v))}; } // AVX
     template <class YMM> ARKXMM_API operator ~(YMM a) -> enable::if_f64x4<YMM> { return {_mm256_xor_pd(a.v, _mm256_castsi256_pd((~zero<vi64x4>()).v))}; } // AVX
+    template <class ZMM> ARKXMM_API operator ~(ZMM a) -> enable::if_iZMM<ZMM> { return {_mm512_ternarylogic_epi32(a.v, a.v, a.v, 0x55)}; }                // AVX512F
     template <class XMM> ARKXMM_API operator &(XMM a, XMM b) -> enable::if_iXMM<XMM> { return {_mm_and_si128(a.v, b.v)}; }                                // SSE2
     template <class XMM> ARKXMM_API operator &(XMM a, XMM b) -> enable::if_f32x4<XMM> { return {_mm_and_ps(a.v, b.v)}; }                                  // SSE
     template <class XMM> ARKXMM_API operator &(XMM a, XMM b) -> enable::if_f64x2<XMM> { return {_mm_and_pd(a.v, b.v)}; }                                  // SSE2
     template <class YMM> ARKXMM_API operator &(YMM a, YMM b) -> enable::if_iYMM<YMM> { return {_mm256_and_si256(a.v, b.v)}; }                             // AVX2
     template <class YMM> ARKXMM_API operator &(YMM a, YMM b) -> enable::if_f32x8<YMM> { return {_mm256_and_ps(a.v, b.v)}; }                               // AVX
     template <class YMM> ARKXMM_API operator &(YMM a, YMM b) -> enable::if_f64x4<YMM> { return {_mm256_and_pd(a.v, b.v)}; }                               // AVX
+    template <class ZMM> ARKXMM_API operator &(ZMM a, ZMM b) -> enable::if_iZMM<ZMM> { return {_mm512_and_si512(a.v, b.v)}; }                             // AVX512F
     template <class XMM> ARKXMM_API operator |(XMM a, XMM b) -> enable::if_iXMM<XMM> { return {_mm_or_si128(a.v, b.v)}; }                                 // SSE2
     template <class XMM> ARKXMM_API operator |(XMM a, XMM b) -> enable::if_f32x4<XMM> { return {_mm_or_ps(a.v, b.v)}; }                                   // SSE
     template <class XMM> ARKXMM_API operator |(XMM a, XMM b) -> enable::if_f64x2<XMM> { return {_mm_or_pd(a.v, b.v)}; }                                   // SSE2
     template <class YMM> ARKXMM_API operator |(YMM a, YMM b) -> enable::if_iYMM<YMM> { return {_mm256_or_si256(a.v, b.v)}; }                              // AVX2
     template <class YMM> ARKXMM_API operator |(YMM a, YMM b) -> enable::if_f32x8<YMM> { return {_mm256_or_ps(a.v, b.v)}; }                                // AVX
     template <class YMM> ARKXMM_API operator |(YMM a, YMM b) -> enable::if_f64x4<YMM> { return {_mm256_or_pd(a.v, b.v)}; }                                // AVX
+    template <class ZMM> ARKXMM_API operator |(ZMM a, ZMM b) -> enable::if_iZMM<ZMM> { return {_mm512_or_si512(a.v, b.v)}; }                              // AVX512F
     template <class XMM> ARKXMM_API operator ^(XMM a, XMM b) -> enable::if_iXMM<XMM> { return {_mm_xor_si128(a.v, b.v)}; }                                // SSE2
     template <class XMM> ARKXMM_API operator ^(XMM a, XMM b) -> enable::if_f32x4<XMM> { return {_mm_xor_ps(a.v, b.v)}; }                                  // SSE
     template <class XMM> ARKXMM_API operator ^(XMM a, XMM b) -> enable::if_f64x2<XMM> { return {_mm_xor_pd(a.v, b.v)}; }                                  // SSE2
     template <class YMM> ARKXMM_API operator ^(YMM a, YMM b) -> enable::if_iYMM<YMM> { return {_mm256_xor_si256(a.v, b.v)}; }                             // AVX2
     template <class YMM> ARKXMM_API operator ^(YMM a, YMM b) -> enable::if_f32x8<YMM> { return {_mm256_xor_ps(a.v, b.v)}; }                               // AVX
     template <class YMM> ARKXMM_API operator ^(YMM a, YMM b) -> enable::if_f64x4<YMM> { return {_mm256_xor_pd(a.v, b.v)}; }                               // AVX
+    template <class ZMM> ARKXMM_API operator ^(ZMM a, ZMM b) -> enable::if_iZMM<ZMM> { return {_mm512_xor_si512(a.v, b.v)}; }                             // AVX512F
     template <class XMM> ARKXMM_API masked_not(XMM a, XMM mask) -> enable::if_iXMM<XMM> { return {_mm_andnot_si128(a.v, mask.v)}; }                       // SSE2 masked_not(a,mask) := ~a & mask
     template <class XMM> ARKXMM_API masked_not(XMM a, XMM mask) -> enable::if_f32x4<XMM> { return {_mm_andnot_ps(a.v, mask.v)}; }                         // SSE  masked_not(a,mask) := ~a & mask
     template <class XMM> ARKXMM_API masked_not(XMM a, XMM mask) -> enable::if_f64x2<XMM> { return {_mm_andnot_pd(a.v, mask.v)}; }                         // SSE2 masked_not(a,mask) := ~a & mask
     template <class YMM> ARKXMM_API masked_not(YMM a, YMM mask) -> enable::if_iYMM<YMM> { return {_mm256_andnot_si256(a.v, mask.v)}; }                    // AVX2 masked_not(a,mask) := ~a & mask
     template <class YMM> ARKXMM_API masked_not(YMM a, YMM mask) -> enable::if_f32x8<YMM> { return {_mm256_andnot_ps(a.v, mask.v)}; }                      // AVX  masked_not(a,mask) := ~a & mask
     template <class YMM> ARKXMM_API masked_not(YMM a, YMM mask) -> enable::if_f64x4<YMM> { return {_mm256_andnot_pd(a.v, mask.v)}; }                      // AVX  masked_not(a,mask) := ~a & mask
+    template <class ZMM> ARKXMM_API masked_not(ZMM a, ZMM mask) -> enable::if_iZMM<ZMM> { return {_mm512_andnot_si512(a.v, mask.v)}; }                    // AVX512F masked_not(a,mask) := ~a & mask
 
     template <class XMM> ARKXMM_API testz(XMM a, XMM mask) -> enable::if_iXMM<XMM> { return {_mm_testz_si128(a.v, mask.v)}; }        // SSE4.1 testz(a,mask) := all bits are zero: (a & mask) == 0
     template <class XMM> ARKXMM_API testz(XMM a, XMM mask) -> enable::if_f32x4<XMM> { return {_mm_testz_ps(a.v, mask.v)}; }          // AVX    testz(a,mask) := all **sign** bits are zero
@@ -533,6 +652,7 @@ namespace arkana::xmm
     template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3, class XMM> ARKXMM_API shuffle32(XMM v) -> enable::if_f32x4<XMM> { return {_mm_shuffle_ps(v.v, v.v, (i0 & 0b11) | (i1 & 0b11) << 2 | (i2 & 0b11) << 4 | (i3 & 0b11) << 6)}; }                 // SSE2
     template <uint8_t a0, uint8_t a1, uint8_t b2, uint8_t b3, class XMM> ARKXMM_API shuffle32(XMM a, XMM b) -> enable::if_f32x4<XMM> { return {_mm_shuffle_ps(a.v, b.v, (a0 & 0b11) | (a1 & 0b11) << 2 | (b2 & 0b11) << 4 | (b3 & 0b11) << 6)}; }          // SSE2
     template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3, class YMM> ARKXMM_API shuffle32(YMM v) -> enable::if_iYMM<YMM> { return {_mm256_shuffle_epi32(v.v, (i0 & 0b11) | (i1 & 0b11) << 2 | (i2 & 0b11) << 4 | (i3 & 0b11) << 6)}; }                 // AVX2
+    template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3, class ZMM> ARKXMM_API shuffle32(ZMM v) -> enable::if_iZMM<ZMM> { return {_mm512_shuffle_epi32(v.v, static_cast<_MM_PERM_ENUM>((i0 & 0b11) | (i1 & 0b11) << 2 | (i2 & 0b11) << 4 | (i3 & 0b11) << 6))}; } // AVX512F
     template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3, class YMM> ARKXMM_API shuffle32(YMM v) -> enable::if_f32x8<YMM> { return {_mm256_shuffle_ps(v.v, v.v, (i0 & 0b11) | (i1 & 0b11) << 2 | (i2 & 0b11) << 4 | (i3 & 0b11) << 6)}; }              // SSE2
     template <uint8_t a0, uint8_t a1, uint8_t b2, uint8_t b3, class YMM> ARKXMM_API shuffle32(YMM a, YMM b) -> enable::if_f32x8<YMM> { return {_mm256_shuffle_ps(a.v, b.v, (a0 & 0b11) | (a1 & 0b11) << 2 | (b2 & 0b11) << 4 | (b3 & 0b11) << 6)}; }       // AVX
     template <uint8_t i0, uint8_t i1, class XMM> ARKXMM_API shuffle64(XMM v) -> enable::if_iXMM<XMM> { return shuffle32<i0 * 2, i0 * 2 + 1, i1 * 2, i1 * 2 + 1, XMM>(v); }                                                                                 // SSE2
@@ -556,6 +676,8 @@ namespace arkana::xmm
     template <uint8_t a0, uint8_t a1, uint8_t b2, uint8_t b3> ARKXMM_API shuffle(vf32x4 a, vf32x4 b) -> vf32x4 { return shuffle32<a0, a1, b2, b3>(a, b); }           // SSE2
     template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3> ARKXMM_API shuffle(vi32x8 v) -> vi32x8 { return shuffle32<i0, i1, i2, i3>(v); }                        // AVX2
     template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3> ARKXMM_API shuffle(vu32x8 v) -> vu32x8 { return shuffle32<i0, i1, i2, i3>(v); }                        // AVX2
+    template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3> ARKXMM_API shuffle(vi32x16 v) -> vi32x16 { return shuffle32<i0, i1, i2, i3>(v); }                      // AVX512F
+    template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3> ARKXMM_API shuffle(vu32x16 v) -> vu32x16 { return shuffle32<i0, i1, i2, i3>(v); }                      // AVX512F
     template <uint8_t i0, uint8_t i1, uint8_t i2, uint8_t i3> ARKXMM_API shuffle(vf32x8 v) -> vf32x8 { return shuffle32<i0, i1, i2, i3>(v); }                        // AVX
     template <uint8_t a0, uint8_t a1, uint8_t b2, uint8_t b3> ARKXMM_API shuffle(vf32x8 a, vf32x8 b) -> vf32x8 { return shuffle32<a0, a1, b2, b3>(a, b); }           // AVX
     template <uint8_t i0, uint8_t i1> ARKXMM_API shuffle(vi64x2 v) -> vi64x2 { return shuffle64<i0, i1>(v); }                                                        // SSE2
@@ -598,6 +720,12 @@ namespace arkana::xmm
     ARKXMM_API operator +(vi64x4 a, vi64x4 b) -> vi64x4 { return {_mm256_add_epi64(a.v, b.v)}; }    // AVX2
     ARKXMM_API operator +(vu64x4 a, vu64x4 b) -> vu64x4 { return {_mm256_add_epi64(a.v, b.v)}; }    // AVX2
     ARKXMM_API operator +(vf64x4 a, vf64x4 b) -> vf64x4 { return {_mm256_add_pd(a.v, b.v)}; }       // AVX
+    ARKXMM_API operator +(vi32x16 a, vi32x16 b) -> vi32x16 { return {_mm512_add_epi32(a.v, b.v)}; } // AVX512F
+    ARKXMM_API operator +(vu32x16 a, vu32x16 b) -> vu32x16 { return {_mm512_add_epi32(a.v, b.v)}; } // AVX512F
+    ARKXMM_API operator +(vf32x16 a, vf32x16 b) -> vf32x16 { return {_mm512_add_ps(a.v, b.v)}; }    // AVX512F
+    ARKXMM_API operator +(vi64x8 a, vi64x8 b) -> vi64x8 { return {_mm512_add_epi64(a.v, b.v)}; }    // AVX512F
+    ARKXMM_API operator +(vu64x8 a, vu64x8 b) -> vu64x8 { return {_mm512_add_epi64(a.v, b.v)}; }    // AVX512F
+    ARKXMM_API operator +(vf64x8 a, vf64x8 b) -> vf64x8 { return {_mm512_add_pd(a.v, b.v)}; }       // AVX512F
 
     ARKXMM_API add_sat(vi8x16 a, vi8x16 b) -> vi8x16 { return {_mm_adds_epi8(a.v, b.v)}; }        // SSE2
     ARKXMM_API add_sat(vu8x16 a, vu8x16 b) -> vu8x16 { return {_mm_adds_epu8(a.v, b.v)}; }        // SSE2
@@ -628,6 +756,12 @@ namespace arkana::xmm
     ARKXMM_API operator -(vi64x4 a, vi64x4 b) -> vi64x4 { return {_mm256_sub_epi64(a.v, b.v)}; }    // AVX2
     ARKXMM_API operator -(vu64x4 a, vu64x4 b) -> vu64x4 { return {_mm256_sub_epi64(a.v, b.v)}; }    // AVX2
     ARKXMM_API operator -(vf64x4 a, vf64x4 b) -> vf64x4 { return {_mm256_sub_pd(a.v, b.v)}; }       // AVX
+    ARKXMM_API operator -(vi32x16 a, vi32x16 b) -> vi32x16 { return {_mm512_sub_epi32(a.v, b.v)}; } // AVX512F
+    ARKXMM_API operator -(vu32x16 a, vu32x16 b) -> vu32x16 { return {_mm512_sub_epi32(a.v, b.v)}; } // AVX512F
+    ARKXMM_API operator -(vf32x16 a, vf32x16 b) -> vf32x16 { return {_mm512_sub_ps(a.v, b.v)}; }    // AVX512F
+    ARKXMM_API operator -(vi64x8 a, vi64x8 b) -> vi64x8 { return {_mm512_sub_epi64(a.v, b.v)}; }    // AVX512F
+    ARKXMM_API operator -(vu64x8 a, vu64x8 b) -> vu64x8 { return {_mm512_sub_epi64(a.v, b.v)}; }    // AVX512F
+    ARKXMM_API operator -(vf64x8 a, vf64x8 b) -> vf64x8 { return {_mm512_sub_pd(a.v, b.v)}; }       // AVX512F
 
     ARKXMM_API sub_sat(vi8x16 a, vi8x16 b) -> vi8x16 { return {_mm_subs_epi8(a.v, b.v)}; }        // SSE2
     ARKXMM_API sub_sat(vu8x16 a, vu8x16 b) -> vu8x16 { return {_mm_subs_epu8(a.v, b.v)}; }        // SSE2
@@ -689,6 +823,10 @@ namespace arkana::xmm
     /* ARKXMM_API operator *(vi64x4 a, vi64x4 b) -> vi64x4 { return { _mm256_mullo_epi64(a.v, b.v) }; } */ // AVX512VL + AVX512DQ
     /* ARKXMM_API operator *(vu64x4 a, vu64x4 b) -> vu64x4 { return { _mm256_mullo_epi64(a.v, b.v) }; } */ // AVX512VL + AVX512DQ
     ARKXMM_API operator *(vf64x4 a, vf64x4 b) -> vf64x4 { return {_mm256_mul_pd(a.v, b.v)}; }              // AVX
+    ARKXMM_API operator *(vi32x16 a, vi32x16 b) -> vi32x16 { return {_mm512_mullo_epi32(a.v, b.v)}; }      // AVX512F
+    ARKXMM_API operator *(vu32x16 a, vu32x16 b) -> vu32x16 { return {_mm512_mullo_epi32(a.v, b.v)}; }      // AVX512F
+    ARKXMM_API operator *(vf32x16 a, vf32x16 b) -> vf32x16 { return {_mm512_mul_ps(a.v, b.v)}; }           // AVX512F
+    ARKXMM_API operator *(vf64x8 a, vf64x8 b) -> vf64x8 { return {_mm512_mul_pd(a.v, b.v)}; }              // AVX512F
 
     ARKXMM_API mul_lo(vi16x8 a, vi16x8 b) -> vi16x8 { return {_mm_mullo_epi16(a.v, b.v)}; }         // SSE2
     ARKXMM_API mul_lo(vu16x8 a, vu16x8 b) -> vu16x8 { return {_mm_mullo_epi16(a.v, b.v)}; }         // SSE2
@@ -704,6 +842,8 @@ namespace arkana::xmm
     ARKXMM_API mul32x32to64(vu32x4 a, vu32x4 b) -> vu64x2 { return {_mm_mul_epu32(a.v, b.v)}; }     // SSE2 -> [a0*b0, a2*b2]
     ARKXMM_API mul32x32to64(vi32x8 a, vi32x8 b) -> vi64x4 { return {_mm256_mul_epi32(a.v, b.v)}; }  // AVX2 -> [a0*b0, a2*b2, a4*b4, a6*b6]
     ARKXMM_API mul32x32to64(vu32x8 a, vu32x8 b) -> vu64x4 { return {_mm256_mul_epu32(a.v, b.v)}; }  // AVX2 -> [a0*b0, a2*b2, a4*b4, a6*b6]
+    ARKXMM_API mul32x32to64(vi32x16 a, vi32x16 b) -> vi64x8 { return {_mm512_mul_epi32(a.v, b.v)}; } // AVX512F -> [a0*b0, a2*b2, ..., a14*b14]
+    ARKXMM_API mul32x32to64(vu32x16 a, vu32x16 b) -> vu64x8 { return {_mm512_mul_epu32(a.v, b.v)}; } // AVX512F -> [a0*b0, a2*b2, ..., a14*b14]
 
     ARKXMM_API mul_hadd(vi16x8 a, vi16x8 b) -> vi32x4 { return {_mm_madd_epi16(a.v, b.v)}; }      // SSE2 -> { i32(a0*b0)+i32(a1*b1), i32(a2*b2)+i32(a3*b3), ..., i32(a6*b6)+i32(a7*b7) }
     ARKXMM_API mul_hadd(vi16x16 a, vi16x16 b) -> vi32x8 { return {_mm256_madd_epi16(a.v, b.v)}; } // AVX2 -> { i32(a0*b0)+i32(a1*b1), i32(a2*b2)+i32(a3*b3), ..., i32(a14*b14)+i32(a15*b15) }
@@ -725,6 +865,9 @@ namespace arkana::xmm
     ARKXMM_API operator <<(vu64x2 a, int i) -> vu64x2 { return {_mm_slli_epi64(a.v, i)}; }           // SSE2
     /* ARKXMM_API operator <<(vi64x4 a, int i) -> vi64x4 { return {_mm256_slli_epi64(a.v, i)}; }  */ // AVX2
     ARKXMM_API operator <<(vu64x4 a, int i) -> vu64x4 { return {_mm256_slli_epi64(a.v, i)}; }        // AVX2
+    ARKXMM_API operator <<(vi32x16 a, int i) -> vi32x16 { return {_mm512_slli_epi32(a.v, static_cast<unsigned>(i))}; } // AVX512F
+    ARKXMM_API operator <<(vu32x16 a, int i) -> vu32x16 { return {_mm512_slli_epi32(a.v, static_cast<unsigned>(i))}; } // AVX512F
+    ARKXMM_API operator <<(vu64x8 a, int i) -> vu64x8 { return {_mm512_slli_epi64(a.v, static_cast<unsigned>(i))}; }   // AVX512F
 
     ARKXMM_API operator >>(vi16x8 a, int i) -> vi16x8 { return {_mm_srai_epi16(a.v, i)}; }            // SSE2
     ARKXMM_API operator >>(vu16x8 a, int i) -> vu16x8 { return {_mm_srli_epi16(a.v, i)}; }            // SSE2
@@ -738,6 +881,9 @@ namespace arkana::xmm
     ARKXMM_API operator >>(vu64x2 a, int i) -> vu64x2 { return {_mm_srli_epi64(a.v, i)}; }            // SSE2
     /* ARKXMM_API operator >>(vi64x4 a, int i) -> vi64x4 { return { _mm256_srai_epi64(a.v, i) }; } */ // AVX512VL + AVX512F
     ARKXMM_API operator >>(vu64x4 a, int i) -> vu64x4 { return {_mm256_srli_epi64(a.v, i)}; }         // AVX2
+    ARKXMM_API operator >>(vi32x16 a, int i) -> vi32x16 { return {_mm512_srai_epi32(a.v, static_cast<unsigned>(i))}; } // AVX512F
+    ARKXMM_API operator >>(vu32x16 a, int i) -> vu32x16 { return {_mm512_srli_epi32(a.v, static_cast<unsigned>(i))}; } // AVX512F
+    ARKXMM_API operator >>(vu64x8 a, int i) -> vu64x8 { return {_mm512_srli_epi64(a.v, static_cast<unsigned>(i))}; }   // AVX512F
 
     ARKXMM_API operator <<(vi16x8 a, SHIFT i) -> vi16x8 { return {_mm_sll_epi16(a.v, i)}; }            // SSE2
     ARKXMM_API operator <<(vu16x8 a, SHIFT i) -> vu16x8 { return {_mm_sll_epi16(a.v, i)}; }            // SSE2
@@ -923,10 +1069,13 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API unpack16_lo(YMM l, YMM h) -> enable::if_iYMM<YMM> { return {_mm256_unpacklo_epi16(l.v, h.v)}; }    // AVX2 {l0... l7| l8...l15}, {h0... h7| h8...h15} -> {l0,h0,...,l3,h3 | l8,h8,...,l11,h11}
     template <class XMM> ARKXMM_API unpack32_lo(XMM l, XMM h) -> enable::if_iXMM<XMM> { return {_mm_unpacklo_epi32(l.v, h.v)}; }       // SSE2 {l0... l3}, {h0... h3} -> {l0,h0,l1,h1}
     template <class YMM> ARKXMM_API unpack32_lo(YMM l, YMM h) -> enable::if_iYMM<YMM> { return {_mm256_unpacklo_epi32(l.v, h.v)}; }    // AVX2 {l0... l3| l4... l7}, {h0... h3| h4... h7} -> {l0,h0,l1,h1 | l4,h4,l5,h5}
+    // ZMM unpack*/shuffle128/rotl/rotr use maskz forms with full masks: same instructions, without the _mm512_undefined_* passthrough GCC reports as maybe-uninitialized.
+    template <class ZMM> ARKXMM_API unpack32_lo(ZMM l, ZMM h) -> enable::if_iZMM<ZMM> { return {_mm512_maskz_unpacklo_epi32(0xFFFF, l.v, h.v)}; }    // AVX512F (per 128-bit lane)
     template <class XMM> ARKXMM_API unpack32_lo(XMM l, XMM h) -> enable::if_f32x4<XMM> { return {_mm_unpacklo_ps(l.v, h.v)}; }         // SSE  {l0... l3}, {h0... h3} -> {l0,h0,l1,h1}
     template <class YMM> ARKXMM_API unpack32_lo(YMM l, YMM h) -> enable::if_f32x8<YMM> { return {_mm256_unpacklo_ps(l.v, h.v)}; }      // AVX  {l0... l3| l4... l7}, {h0... h3| h4... h7} -> {l0,h0,l1,h1 | l4,h4,l5,h5}
     template <class XMM> ARKXMM_API unpack64_lo(XMM l, XMM h) -> enable::if_iXMM<XMM> { return {_mm_unpacklo_epi64(l.v, h.v)}; }       // SSE2 {l0... l1}, {h0... h1} -> {l0,h0}
     template <class YMM> ARKXMM_API unpack64_lo(YMM l, YMM h) -> enable::if_iYMM<YMM> { return {_mm256_unpacklo_epi64(l.v, h.v)}; }    // AVX2 {l0... l1| l2... l3}, {h0... h1| h2... h3} -> {l0,h0|l2,h2}
+    template <class ZMM> ARKXMM_API unpack64_lo(ZMM l, ZMM h) -> enable::if_iZMM<ZMM> { return {_mm512_maskz_unpacklo_epi64(0xFF, l.v, h.v)}; }    // AVX512F (per 128-bit lane)
     template <class XMM> ARKXMM_API unpack64_lo(XMM l, XMM h) -> enable::if_f64x2<XMM> { return {_mm_unpacklo_pd(l.v, h.v)}; }         // SSE2 {l0... l1}, {h0... h1} -> {l0,h0}
     template <class YMM> ARKXMM_API unpack64_lo(YMM l, YMM h) -> enable::if_f64x4<YMM> { return {_mm256_unpacklo_pd(l.v, h.v)}; }      // AVX  {l0... l1| l2... l3}, {h0... h1| h2... h3} -> {l0,h0|l2,h2}
     template <class XMM> ARKXMM_API unpack64_lo(XMM l, XMM h) -> enable::if_f32x4<XMM> { return {_mm_shuffle_ps(l.v, h.v, 0x44)}; }    // SSE2 {l0... l1}, {h0... h1} -> {l0,h0}
@@ -937,10 +1086,12 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API unpack16_hi(YMM l, YMM h) -> enable::if_iYMM<YMM> { return {_mm256_unpackhi_epi16(l.v, h.v)}; }    // AVX2 {l0... l7| l8...l15}, {h0... h7| h8...h15} -> {l4,h4,...,l7,h7 | l12,h12,...,l15,h15}
     template <class XMM> ARKXMM_API unpack32_hi(XMM l, XMM h) -> enable::if_iXMM<XMM> { return {_mm_unpackhi_epi32(l.v, h.v)}; }       // SSE2 {l0... l3}, {h0... h3} -> {l2,h2,l3,h3}
     template <class YMM> ARKXMM_API unpack32_hi(YMM l, YMM h) -> enable::if_iYMM<YMM> { return {_mm256_unpackhi_epi32(l.v, h.v)}; }    // AVX2 {l0... l3| l4... l7}, {h0... h3| h4... h7} -> {l2,h2,l3,h3 | l6,h6,l7,h7}
+    template <class ZMM> ARKXMM_API unpack32_hi(ZMM l, ZMM h) -> enable::if_iZMM<ZMM> { return {_mm512_maskz_unpackhi_epi32(0xFFFF, l.v, h.v)}; }    // AVX512F (per 128-bit lane)
     template <class XMM> ARKXMM_API unpack32_hi(XMM l, XMM h) -> enable::if_f32x4<XMM> { return {_mm_unpackhi_ps(l.v, h.v)}; }         // SSE  {l0... l3}, {h0... h3} -> {l2,h2,l3,h3}
     template <class YMM> ARKXMM_API unpack32_hi(YMM l, YMM h) -> enable::if_f32x8<YMM> { return {_mm256_unpackhi_ps(l.v, h.v)}; }      // AVX  {l0... l3| l4... l7}, {h0... h3| h4... h7} -> {l2,h2,l3,h3 | l6,h6,l7,h7}
     template <class XMM> ARKXMM_API unpack64_hi(XMM l, XMM h) -> enable::if_iXMM<XMM> { return {_mm_unpackhi_epi64(l.v, h.v)}; }       // SSE2 {l0... l1}, {h0... h1} -> {l1,h1}
     template <class YMM> ARKXMM_API unpack64_hi(YMM l, YMM h) -> enable::if_iYMM<YMM> { return {_mm256_unpackhi_epi64(l.v, h.v)}; }    // AVX2 {l0... l1| l2... l3}, {h0... h1| h2... h3} -> {l1,h1 | l3,h3}
+    template <class ZMM> ARKXMM_API unpack64_hi(ZMM l, ZMM h) -> enable::if_iZMM<ZMM> { return {_mm512_maskz_unpackhi_epi64(0xFF, l.v, h.v)}; }    // AVX512F (per 128-bit lane)
     template <class XMM> ARKXMM_API unpack64_hi(XMM l, XMM h) -> enable::if_f32x4<XMM> { return {_mm_shuffle_ps(l.v, h.v, 0xEE)}; }    // SSE2 {l0... l1}, {h0... h1} -> {l0,h0}
     template <class YMM> ARKXMM_API unpack64_hi(YMM l, YMM h) -> enable::if_f32x8<YMM> { return {_mm256_shuffle_ps(l.v, h.v, 0xEE)}; } // AVX  {l0... l1| l2... l3}, {h0... h1| h2... h3} -> {l0,h0|l2,h2}
     template <class XMM> ARKXMM_API unpack64_hi(XMM l, XMM h) -> enable::if_f64x2<XMM> { return {_mm_unpackhi_pd(l.v, h.v)}; }         // SSE2 {l0... l1}, {h0... h1} -> {l1,h1}
@@ -994,6 +1145,11 @@ namespace arkana::xmm
     template <class YMM> ARKXMM_API higher128(YMM a) -> enable::if_f32x8<YMM, XMM<typename YMM::element_t>> { return {_mm256_extractf128_ps(a.v, 1)}; }   // AVX
     template <class YMM> ARKXMM_API higher128(YMM a) -> enable::if_f64x4<YMM, XMM<typename YMM::element_t>> { return {_mm256_extractf128_pd(a.v, 1)}; }   // AVX
 
+    // avx512 permute
+    template <uint8_t a0, uint8_t a1, uint8_t b2, uint8_t b3, class ZMM> ARKXMM_API shuffle128(ZMM a, ZMM b) -> enable::if_iZMM<ZMM> { return {_mm512_maskz_shuffle_i32x4(0xFFFF, a.v, b.v, (a0 & 0b11) | (a1 & 0b11) << 2 | (b2 & 0b11) << 4 | (b3 & 0b11) << 6)}; } // AVX512F {a[a0],a[a1],b[b2],b[b3]}
+    template <class ZMM> ARKXMM_API lower256(ZMM a) -> enable::if_iZMM<ZMM, YMM<typename ZMM::element_t>> { return {_mm512_castsi512_si256(a.v)}; }          // AVX512F
+    template <class ZMM> ARKXMM_API higher256(ZMM a) -> enable::if_iZMM<ZMM, YMM<typename ZMM::element_t>> { return {_mm512_extracti64x4_epi64(a.v, 1)}; } // AVX512F
+
     // type conversion
     template <class To> ARKXMM_API convert_cast(vi8x16 i8x8) -> enable::if_<To, vi16x8> { return {_mm_cvtepi8_epi16(i8x8.v)}; }    // SSE4.1
     template <class To> ARKXMM_API convert_cast(vi8x16 i8x8) -> enable::if_<To, vu16x8> { return {_mm_cvtepi8_epi16(i8x8.v)}; }    // SSE4.1
@@ -1080,6 +1236,9 @@ namespace arkana::xmm
     // NTA prefetch
     ARKXMM_API prefetch_nta(const void* p) -> void { return _mm_prefetch(static_cast<const char*>(p), _MM_HINT_NTA); }
 
+    // SFENCE: orders preceding (non-temporal) stores before following stores.
+    ARKXMM_API store_fence() -> void { return _mm_sfence(); }
+
     // PCLMULQDQ carry-less integer multiplication
     template <int i0, int i1> ARKXMM_API clmul(vu64x2 a, vu64x2 b) -> vx128x1 { return {_mm_clmulepi64_si128(a.v, b.v, (i0 & 1) | (i1 & 1) << 4)}; } // PCLMULQDQ carry-less integer multiplication
 
@@ -1131,6 +1290,14 @@ namespace arkana::xmm
     ARKXMM_API rotr(vu32x8 v, int i) -> vu32x8 { return v >> (i & 31) | v << (-i & 31); }
     ARKXMM_API rotr(vu64x2 v, int i) -> vu64x2 { return v >> (i & 63) | v << (-i & 63); }
     ARKXMM_API rotr(vu64x4 v, int i) -> vu64x4 { return v >> (i & 63) | v << (-i & 63); }
+    ARKXMM_API rotl(vu32x16 v, int i) -> vu32x16 { return {_mm512_rolv_epi32(v.v, _mm512_set1_epi32(i))}; } // AVX512F
+    ARKXMM_API rotl(vu64x8 v, int i) -> vu64x8 { return {_mm512_rolv_epi64(v.v, _mm512_set1_epi64(i))}; }    // AVX512F
+    ARKXMM_API rotr(vu32x16 v, int i) -> vu32x16 { return {_mm512_rorv_epi32(v.v, _mm512_set1_epi32(i))}; } // AVX512F
+    ARKXMM_API rotr(vu64x8 v, int i) -> vu64x8 { return {_mm512_rorv_epi64(v.v, _mm512_set1_epi64(i))}; }    // AVX512F
+    template <int i> ARKXMM_API rotl(vu32x16 v) -> vu32x16 { return {_mm512_maskz_rol_epi32(0xFFFF, v.v, i & 31)}; }      // AVX512F vprold
+    template <int i> ARKXMM_API rotl(vu64x8 v) -> vu64x8 { return {_mm512_maskz_rol_epi64(0xFF, v.v, i & 63)}; }        // AVX512F vprolq
+    template <int i> ARKXMM_API rotr(vu32x16 v) -> vu32x16 { return {_mm512_maskz_ror_epi32(0xFFFF, v.v, i & 31)}; }      // AVX512F vprord
+    template <int i> ARKXMM_API rotr(vu64x8 v) -> vu64x8 { return {_mm512_maskz_ror_epi64(0xFF, v.v, i & 63)}; }        // AVX512F vprorq
     ARKXMM_API byteswap(vu16x8 v) -> vu16x8 { return byte_shuffle_128(v, from_values<vi8x16>(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)); }
     ARKXMM_API byteswap(vu16x16 v) -> vu16x16 { return byte_shuffle_128(v, from_values<vi8x32>(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14)); }
     ARKXMM_API byteswap(vu32x4 v) -> vu32x4 { return byte_shuffle_128(v, from_values<vi8x16>(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)); }
@@ -1179,9 +1346,32 @@ namespace arkana::xmm
         x2 = xmm::unpack64_lo(t1, t3);      // x2 = {2,6,A,E} <- {2,6,_,_},{A,E,_,_}
         x3 = xmm::unpack64_hi(t1, t3);      // x3 = {3,7,B,F} <- {_,_,3,7},{_,_,B,F}
     }
+
+    template <class ZMM>
+    ARKXMM_API transpose_128x4x4(
+        ZMM& /* { 0,1,2,3 } */ x0,
+        ZMM& /* { 4,5,6,7 } */ x1,
+        ZMM& /* { 8,9,A,B } */ x2,
+        ZMM& /* { C,D,E,F } */ x3) -> enable::if_iZMM<ZMM, void>
+    {
+        auto t0 = xmm::shuffle128<0, 1, 0, 1>(x0, x1); // t0 = {0,1,4,5}
+        auto t1 = xmm::shuffle128<2, 3, 2, 3>(x0, x1); // t1 = {2,3,6,7}
+        auto t2 = xmm::shuffle128<0, 1, 0, 1>(x2, x3); // t2 = {8,9,C,D}
+        auto t3 = xmm::shuffle128<2, 3, 2, 3>(x2, x3); // t3 = {A,B,E,F}
+        x0 = xmm::shuffle128<0, 2, 0, 2>(t0, t2);      // x0 = {0,4,8,C}
+        x1 = xmm::shuffle128<1, 3, 1, 3>(t0, t2);      // x1 = {1,5,9,D}
+        x2 = xmm::shuffle128<0, 2, 0, 2>(t1, t3);      // x2 = {2,6,A,E}
+        x3 = xmm::shuffle128<1, 3, 1, 3>(t1, t3);      // x3 = {3,7,B,F}
+    }
 }
 
+#ifdef ARKXMM_NAMESPACE_IS_DEFAULT
 namespace arkxmm
 {
     using namespace arkana::xmm;
 }
+#undef ARKXMM_NAMESPACE_IS_DEFAULT
+#endif
+
+#undef ARKXMM_NAMESPACE
+#endif
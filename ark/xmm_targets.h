@@ -0,0 +1,63 @@
+/// @file
+/// @brief	arkana::xmm - x86 SIMD Operation wrappers compiled for each target ISA
+/// @author Copyright(c) 2023 ttsuki
+///
+/// This software is released under the MIT License.
+/// https://opensource.org/licenses/MIT
+///
+/// Defines copies of arkana::xmm, each compiled for one target ISA,
+/// so that kernels for several ISAs can live in one binary and be selected at runtime.
+///   arkana::xmm_sse2   : SSE2
+///   arkana::xmm_ssse3  : SSSE3
+///   arkana::xmm_avx2   : AVX2
+///   arkana::xmm_avx512 : AVX-512F + AVX-512VL
+/// Kernels using them must be defined in the same ARKANA_TARGET_REGION.
+
+#pragma once
+
+#include "./cpu_features.h"
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+
+// standard headers must be included outside of target regions.
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <array>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi" // wider vector types in unused wrappers
+#endif
+
+ARKANA_TARGET_REGION_BEGIN("sse2")
+#define ARKXMM_NAMESPACE xmm_sse2
+#include "./xmm.h"
+ARKANA_TARGET_REGION_END()
+
+ARKANA_TARGET_REGION_BEGIN("ssse3")
+#define ARKXMM_NAMESPACE xmm_ssse3
+#include "./xmm.h"
+ARKANA_TARGET_REGION_END()
+
+ARKANA_TARGET_REGION_BEGIN("avx2")
+#define ARKXMM_NAMESPACE xmm_avx2
+#include "./xmm.h"
+ARKANA_TARGET_REGION_END()
+
+ARKANA_TARGET_REGION_BEGIN("avx512f,avx512vl")
+#define ARKXMM_NAMESPACE xmm_avx512
+#include "./xmm.h"
+ARKANA_TARGET_REGION_END()
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif
@@ -8,26 +8,58 @@
 #include <cstdint>
 #include <cstring>
 #include <type_traits>
+#include <utility>
 #include <array>
-
-#ifdef __RESHARPER__
-#define __AVX2__
-#endif
+#include <atomic>
 
 #include "../ark/intrinsics.h"
 #include "../ark/ctr_cipher_stream_helper.h"
-
-#ifdef __AVX2__
-#include "../ark/xmm.h"
-#endif
+#include "../ark/cpu_features.h"
+#include "../ark/xmm_targets.h"
 
 namespace chacha20
 {
     using byte = uint8_t;
     using key = std::array<byte, 32>;
     using nonce = std::array<byte, 12>;
-    using position_t = uint64_t; // max 256 GiB
+    using nonce64 = std::array<byte, 8>; // 64-bit counter layout (ctr64)
+    using hnonce = std::array<byte, 16>; // HChaCha20 input
+    using xnonce = std::array<byte, 24>; // XChaCha20
+    using position_t = uint64_t; // max 256 GiB (32-bit block counter)
     using counter_t = uint32_t;
+    using counter64_t = uint64_t;
+
+    using chacha_state = std::array<uint32_t, 16>;
+
+    // context (shared by all backends)
+    struct context_t
+    {
+        chacha_state zero;
+    };
+
+    // one stream of a process_streams batch: process_stream(*ctx, input, output, position, length)
+    struct stream_job
+    {
+        const context_t* ctx;
+        position_t position;
+        const void* input;
+        void* output;
+        size_t length;
+    };
+
+    // process_stream/generate_keystream calls of this length or longer write output with non-temporal stores,
+    // so that bulk output does not evict the working set from caches. (SIMD backends, output aligned to vector size)
+    // disabled (SIZE_MAX) by default.
+    inline std::atomic<size_t>& non_temporal_threshold() noexcept
+    {
+        static std::atomic<size_t> threshold{SIZE_MAX};
+        return threshold;
+    }
+
+    inline void set_non_temporal_threshold(size_t bytes) noexcept
+    {
+        non_temporal_threshold().store(bytes, std::memory_order_relaxed);
+    }
 
     // private impl
     namespace common::impl
@@ -42,53 +74,306 @@ namespace chacha20
             b = rotl(b ^= c += d, 7);
         }
 
-        template <class context_t, class block_t>
-        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        // "expand 32-byte k"
+        static constexpr std::array<uint32_t, 4> sigma = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,};
+
+        static context_t prepare_context(const key* key, const nonce* nonce, counter_t initial_counter = 0)
+        {
+            context_t ctx{};
+            std::memcpy(ctx.zero.data() + 0, &sigma, sizeof(uint32_t) * 4);            // 0..3
+            std::memcpy(ctx.zero.data() + 4, key, sizeof(uint32_t) * 8);               // 4..11
+            std::memcpy(ctx.zero.data() + 12, &initial_counter, sizeof(uint32_t) * 1); // 12..12
+            std::memcpy(ctx.zero.data() + 13, nonce, sizeof(uint32_t) * 3);            // 13..16
+            return ctx;
+        }
+
+        static context_t prepare_context(const key* key, const nonce64* nonce, counter64_t initial_counter)
+        {
+            context_t ctx{};
+            std::memcpy(ctx.zero.data() + 0, &sigma, sizeof(uint32_t) * 4);            // 0..3
+            std::memcpy(ctx.zero.data() + 4, key, sizeof(uint32_t) * 8);               // 4..11
+            std::memcpy(ctx.zero.data() + 12, &initial_counter, sizeof(uint32_t) * 2); // 12..13
+            std::memcpy(ctx.zero.data() + 14, nonce, sizeof(uint32_t) * 2);            // 14..15
+            return ctx;
+        }
+
+        // block counter (words 12..13) of block (first_block + j) for lane j.
+        // 32-bit counter wraps around in word 12 (word 13 is nonce), 64-bit counter carries into word 13.
+        template <class counter_type, size_t lanes>
+        static ARKANA_FORCEINLINE void get_block_counters(const context_t& ctx, counter_type first_block, std::array<uint32_t, lanes>& w12, std::array<uint32_t, lanes>& w13) noexcept
         {
-            return arkana::ctr_cipher_stream_helper::process_stream_with_ctr<block_t, counter_t, position_t>(
-                [](const context_t& ctx, const block_t* input, block_t* output, counter_t counter, size_t block_count)
+            for (size_t j = 0; j < lanes; j++)
+            {
+                if constexpr (sizeof(counter_type) == sizeof(uint64_t))
+                {
+                    uint64_t c = (uint64_t{ctx.zero[13]} << 32 | ctx.zero[12]) + first_block + j;
+                    w12[j] = static_cast<uint32_t>(c);
+                    w13[j] = static_cast<uint32_t>(c >> 32);
+                }
+                else
                 {
-                    for (size_t i = 0; i < block_count; ++i, ++counter, ++input, ++output)
-                        process_block(ctx, counter, input, output); // ADL
-                },
+                    w12[j] = static_cast<uint32_t>(ctx.zero[12] + first_block + j);
+                    w13[j] = ctx.zero[13];
+                }
+            }
+        }
+
+        // process_blocks(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        template <class block_t, class counter_type, class process_blocks_function>
+        static void process_stream(process_blocks_function&& process_blocks, const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return arkana::ctr_cipher_stream_helper::process_stream_with_ctr<block_t, counter_type, position_t>(
+                process_blocks,
+                ctx,
+                static_cast<const std::byte*>(input),
+                static_cast<std::byte*>(output),
+                position, length);
+        }
+
+        // process_partial(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        template <class block_t, class counter_type, class process_blocks_function, class process_partial_function>
+        static void process_stream(process_blocks_function&& process_blocks, process_partial_function&& process_partial, const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return arkana::ctr_cipher_stream_helper::process_stream_with_ctr<block_t, counter_type, position_t>(
+                process_blocks,
+                process_partial,
                 ctx,
                 static_cast<const std::byte*>(input),
                 static_cast<std::byte*>(output),
                 position, length);
         }
+
+        // processes a head or tail shorter than block_t, generating key stream only for the 64-byte blocks it touches.
+        // generate_key_stream(const context_t& ctx, counter_type first_block, size_t block_count, std::byte* key_stream)
+        // store_partial(std::byte* output, const std::byte* input, const std::byte* key_stream, size_t length)
+        template <class block_t, class counter_type, class generate_key_stream_function, class store_partial_function>
+        static ARKANA_FORCEINLINE void process_partial(generate_key_stream_function&& generate_key_stream, store_partial_function&& store_partial, const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        {
+            const size_t offset = static_cast<size_t>(position % 64);
+            const size_t block_count = (offset + length + 63) / 64;
+
+            // key stream buffer is whole block_t, so that store_partial may read it by whole vectors.
+            alignas(64) std::byte key_stream[sizeof(block_t)];
+            generate_key_stream(ctx, static_cast<counter_type>(position / 64), block_count, key_stream);
+            store_partial(output, input, key_stream + offset, length);
+        }
+
+        // a 64-byte block of a stream_job, processed in one SIMD lane of multi-buffer kernels.
+        struct lane_block
+        {
+            const context_t* ctx;
+            position_t block_index;  // stream position / 64
+            const std::byte* input;  // bytes [offset, offset + length) of the block
+            std::byte* output;
+            size_t offset;
+            size_t length;
+        };
+
+        // splits stream_jobs into lane_blocks, in order.
+        // runs of whole block_t (bulk_min_length bytes or more) are passed to process_bulk instead.
+        // process_bulk(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        template <class block_t, size_t bulk_min_length, class process_bulk_function>
+        class lane_block_iterator
+        {
+        public:
+            lane_block_iterator(const stream_job* jobs, size_t count, process_bulk_function process_bulk) noexcept
+                : job_(jobs), end_(jobs + count), process_bulk_(process_bulk) {}
+
+            // fills up to lanes blocks. returns the number of blocks filled (0 at the end).
+            template <size_t lanes>
+            size_t next(std::array<lane_block, lanes>& blocks) noexcept
+            {
+                size_t n = 0;
+                while (n < lanes && job_ != end_)
+                {
+                    if (done_ == job_->length)
+                    {
+                        ++job_;
+                        done_ = 0;
+                        continue;
+                    }
+
+                    const position_t position = job_->position + done_;
+                    if (position % sizeof(block_t) == 0 && job_->length - done_ >= bulk_min_length)
+                    {
+                        const size_t length = (job_->length - done_) / sizeof(block_t) * sizeof(block_t);
+                        process_bulk_(*job_->ctx, position, static_cast<const std::byte*>(job_->input) + done_, static_cast<std::byte*>(job_->output) + done_, length);
+                        done_ += length;
+                        continue;
+                    }
+
+                    const size_t offset = static_cast<size_t>(position % 64);
+                    const size_t length = std::min<size_t>(64 - offset, job_->length - done_);
+                    blocks[n++] = lane_block{
+                        job_->ctx, position / 64,
+                        static_cast<const std::byte*>(job_->input) + done_,
+                        static_cast<std::byte*>(job_->output) + done_,
+                        offset, length,
+                    };
+                    done_ += length;
+                }
+                return n;
+            }
+
+        private:
+            const stream_job* job_;
+            const stream_job* end_;
+            process_bulk_function process_bulk_;
+            size_t done_ = 0;
+        };
+
+        // initial state of the lane block.
+        template <class counter_type>
+        static ARKANA_FORCEINLINE chacha_state get_lane_state(const lane_block& b) noexcept
+        {
+            std::array<uint32_t, 1> w12, w13;
+            get_block_counters(*b.ctx, static_cast<counter_type>(b.block_index), w12, w13);
+
+            chacha_state state = b.ctx->zero;
+            state[12] = w12[0];
+            state[13] = w13[0];
+            return state;
+        }
     }
 
     // private impl
     namespace ref::impl
     {
-        using chacha_state = std::array<uint32_t, 16>;
-
         using block_t = chacha_state;
 
-        struct context_t
+        using chacha20::context_t;
+        using common::impl::prepare_context;
+
+        template <int rounds>
+        static ARKANA_FORCEINLINE void chacha_rounds(chacha_state& w)
         {
-            chacha_state zero;
-        };
+            for (int j = 0; j < rounds / 2; ++j)
+            {
+                using common::impl::quarter_round;
+                quarter_round(w[0], w[4], w[8], w[12]);
+                quarter_round(w[1], w[5], w[9], w[13]);
+                quarter_round(w[2], w[6], w[10], w[14]);
+                quarter_round(w[3], w[7], w[11], w[15]);
+                quarter_round(w[0], w[5], w[10], w[15]);
+                quarter_round(w[1], w[6], w[11], w[12]);
+                quarter_round(w[2], w[7], w[8], w[13]);
+                quarter_round(w[3], w[4], w[9], w[14]);
+            }
+        }
 
-        static context_t prepare_context(const key* key, const nonce* nonce, counter_t initial_counter = 0)
+        template <int rounds, class counter_type, bool xor_input>
+        static ARKANA_FORCEINLINE void process_block(const context_t& ctx, counter_type counter, const block_t* input, block_t* output)
         {
-            context_t ctx{};
-            constexpr std::array<uint32_t, 4> k = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,};
-            std::memcpy(ctx.zero.data() + 0, &k, sizeof(uint32_t) * 4);                // 0..3
-            std::memcpy(ctx.zero.data() + 4, key, sizeof(uint32_t) * 8);               // 4..11
-            std::memcpy(ctx.zero.data() + 12, &initial_counter, sizeof(uint32_t) * 1); // 12..12
-            std::memcpy(ctx.zero.data() + 13, nonce, sizeof(uint32_t) * 3);            // 13..16
-            return ctx;
+            std::array<uint32_t, 1> w12, w13;
+            common::impl::get_block_counters(ctx, counter, w12, w13);
+
+            auto init = ctx.zero;
+            init[12] = w12[0];
+            init[13] = w13[0];
+
+            auto w = init;
+            chacha_rounds<rounds>(w);
+
+            for (int j = 0; j < 16; ++j)
+                w[j] += init[j];
+
+            for (int i = 0; i < 16; i++)
+                output->operator[](i) = xor_input ? input->operator[](i) ^ w[i] : w[i];
+        }
+
+        template <int rounds, class counter_type, bool xor_input>
+        static void process_blocks(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        {
+            for (size_t i = 0; i < block_count; ++i, ++counter, ++input, ++output)
+                process_block<rounds, counter_type, xor_input>(ctx, counter, input, output);
         }
 
-        static ARKANA_FORCEINLINE void process_block(const context_t& ctx, counter_t counter, const block_t* input, block_t* output)
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true>, ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
         {
-            auto w = ctx.zero;
-            w[12] += counter;
+            // key stream kernels never read input.
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false>, ctx, output, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                impl::process_stream<rounds, counter_type>(*jobs[i].ctx, jobs[i].input, jobs[i].output, jobs[i].position, jobs[i].length);
+        }
 
-            for (int j = 0; j < 10; ++j)
+        // HChaCha: words 0..3 and 12..15 of the permuted state (without feed-forward).
+        template <int rounds>
+        static void hchacha_blocks(const key* keys, const hnonce* nonces, key* subkeys, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                chacha_state w{};
+                std::memcpy(w.data() + 0, &common::impl::sigma, sizeof(uint32_t) * 4); // 0..3
+                std::memcpy(w.data() + 4, &keys[i], sizeof(uint32_t) * 8);            // 4..11
+                std::memcpy(w.data() + 12, &nonces[i], sizeof(uint32_t) * 4);         // 12..15
+
+                chacha_rounds<rounds>(w);
+
+                std::memcpy(subkeys[i].data() + 0, w.data() + 0, sizeof(uint32_t) * 4);
+                std::memcpy(subkeys[i].data() + 16, w.data() + 12, sizeof(uint32_t) * 4);
+                arkintr::secure_be_zero(w);
+            }
+        }
+    }
+}
+
+#if defined(__GNUC__) // GCC, clang
+#define ARKANA_CHACHA20_VEC_AVAILABLE 1
+namespace chacha20
+{
+    // private impl
+    namespace vec::impl
+    {
+        // GCC/Clang vector extension: compiles to SIMD of any target. (portable)
+        static constexpr size_t lanes = 8;
+        using vu32 = uint32_t __attribute__((vector_size(sizeof(uint32_t) * lanes)));
+
+        // vertical layout: each vector holds one state word of 8 blocks.
+        using chacha_state8x = std::array<vu32, 16>;
+
+        // 8 blocks (512 bytes) at once.
+        using block_t = std::array<chacha_state, lanes>;
+
+        using chacha20::context_t;
+        using common::impl::prepare_context;
+
+        // vectors are passed by reference: by-value vector arguments change the ABI on some targets.
+        static ARKANA_FORCEINLINE void quarter_round(vu32& a, vu32& b, vu32& c, vu32& d) noexcept
+        {
+            a += b, d ^= a, d = d << 16 | d >> 16;
+            c += d, b ^= c, b = b << 12 | b >> 20;
+            a += b, d ^= a, d = d << 8 | d >> 24;
+            c += d, b ^= c, b = b << 7 | b >> 25;
+        }
+
+        template <int rounds, class counter_type, bool xor_input>
+        static ARKANA_FORCEINLINE void process_block(const context_t& ctx, counter_type first_block, const block_t* input, block_t* output)
+        {
+            chacha_state8x init;
+            for (int i = 0; i < 16; i++)
+                init[i] = vu32{} + ctx.zero[i];
+
+            // lane j processes block (first_block + j).
+            std::array<uint32_t, lanes> w12, w13;
+            common::impl::get_block_counters(ctx, first_block, w12, w13);
+            std::memcpy(&init[12], w12.data(), sizeof(vu32));
+            std::memcpy(&init[13], w13.data(), sizeof(vu32));
+
+            chacha_state8x w = init;
+            for (int j = 0; j < rounds / 2; ++j)
             {
-                using common::impl::quarter_round;
                 quarter_round(w[0], w[4], w[8], w[12]);
                 quarter_round(w[1], w[5], w[9], w[13]);
                 quarter_round(w[2], w[6], w[10], w[14]);
@@ -99,25 +384,281 @@ namespace chacha20
                 quarter_round(w[3], w[4], w[9], w[14]);
             }
 
-            for (int j = 0; j < 16; ++j)
-                w[j] += ctx.zero[j];
+            for (int i = 0; i < 16; i++)
+                w[i] += init[i];
+
+            // ks[i][j] = word i of block j
+            std::array<std::array<uint32_t, lanes>, 16> ks;
+            std::memcpy(&ks, &w, sizeof(ks));
+
+            for (size_t j = 0; j < lanes; j++)
+                for (int i = 0; i < 16; i++)
+                    output->operator[](j)[i] = xor_input ? input->operator[](j)[i] ^ ks[i][j] : ks[i][j];
+        }
+
+        template <int rounds, class counter_type, bool xor_input>
+        static void process_blocks(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        {
+            for (size_t i = 0; i < block_count; ++i, ++counter, ++input, ++output)
+                process_block<rounds, counter_type, xor_input>(ctx, counter * lanes, input, output);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true>, ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            // key stream kernels never read input.
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false>, ctx, output, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                impl::process_stream<rounds, counter_type>(*jobs[i].ctx, jobs[i].input, jobs[i].output, jobs[i].position, jobs[i].length);
+        }
+    }
+}
+#endif
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+ARKANA_TARGET_REGION_BEGIN("ssse3")
+namespace chacha20
+{
+    // private impl
+    namespace sse::impl
+    {
+        namespace arkxmm = arkana::xmm_ssse3;
+
+        // output = input ^ key_stream, or output = key_stream when !xor_input.
+        // non_temporal: output must be aligned.
+        template <bool xor_input, bool non_temporal = false, class V>
+        ARKXMM_API store_key_stream(void* output, const void* input, V key_stream) noexcept
+        {
+            if constexpr (xor_input) key_stream ^= arkxmm::load_u<V>(input);
+            if constexpr (non_temporal) arkxmm::store_s<V>(output, key_stream);
+            else arkxmm::store_u<V>(output, key_stream);
+        }
+
+        // prefetches input that is read only once.
+        template <class T>
+        ARKXMM_API prefetch_block_nta(const T* p) noexcept
+        {
+            for (size_t i = 0; i < sizeof(T); i += 64)
+                arkxmm::prefetch_nta(reinterpret_cast<const std::byte*>(p) + i);
+        }
+
+        // store_key_stream for partial blocks: 16 bytes at once, then bytes.
+        template <bool xor_input>
+        static void store_key_stream_partial(std::byte* output, const std::byte* input, const std::byte* key_stream, size_t length) noexcept
+        {
+            for (; length >= 16; length -= 16, output += 16, input += 16, key_stream += 16)
+                store_key_stream<xor_input>(output, input, arkxmm::load_u<arkxmm::vu32x4>(key_stream));
+
+            for (size_t i = 0; i < length; i++)
+                output[i] = xor_input ? input[i] ^ key_stream[i] : key_stream[i];
+        }
+
+        // 4 blocks (256 bytes) at once. each vector holds one state word of 4 blocks.
+        using block_t = std::array<arkxmm::vu32x4, 16>;
+
+        using chacha20::context_t;
+        using common::impl::prepare_context;
+
+        ARKXMM_API quarter_round(arkxmm::vu32x4& a, arkxmm::vu32x4& b, arkxmm::vu32x4& c, arkxmm::vu32x4& d) noexcept
+        {
+            d = byte_rotr2(d ^= a += b); // pshufb
+            b = rotl(b ^= c += d, 12);
+            d = byte_rotr3(d ^= a += b); // pshufb
+            b = rotl(b ^= c += d, 7);
+        }
+
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        ARKXMM_API process_block(const context_t& ctx, counter_type first_block, const block_t* input, block_t* output) noexcept
+        {
+            block_t w;
+            for (int i = 0; i < 16; i++)
+                w[i] = arkxmm::broadcast<arkxmm::vu32x4>(ctx.zero[i]);
+
+            // lane j processes block (first_block + j).
+            arkxmm::vu32x4 init_w12, init_w13 = w[13];
+            if constexpr (sizeof(counter_type) == sizeof(uint64_t))
+            {
+                std::array<uint32_t, 4> w12, w13;
+                common::impl::get_block_counters(ctx, first_block, w12, w13);
+                init_w12 = w[12] = arkxmm::load_u<arkxmm::vu32x4>(w12.data());
+                init_w13 = w[13] = arkxmm::load_u<arkxmm::vu32x4>(w13.data());
+            }
+            else
+                init_w12 = w[12] += arkxmm::broadcast<arkxmm::vu32x4>(first_block) + arkxmm::u32x4(0, 1, 2, 3);
 
-            w[12] += counter;
+            for (int j = 0; j < rounds / 2; ++j)
+            {
+                quarter_round(w[0], w[4], w[8], w[12]);
+                quarter_round(w[1], w[5], w[9], w[13]);
+                quarter_round(w[2], w[6], w[10], w[14]);
+                quarter_round(w[3], w[7], w[11], w[15]);
+                quarter_round(w[0], w[5], w[10], w[15]);
+                quarter_round(w[1], w[6], w[11], w[12]);
+                quarter_round(w[2], w[7], w[8], w[13]);
+                quarter_round(w[3], w[4], w[9], w[14]);
+            }
 
             for (int i = 0; i < 16; i++)
-                output->operator[](i) = input->operator[](i) ^ w[i];
+                w[i] += i == 12 ? init_w12 : i == 13 ? init_w13 : arkxmm::broadcast<arkxmm::vu32x4>(ctx.zero[i]);
+
+            // w[4g+k] = { block k: words 4g..4g+3 }
+            arkxmm::transpose_32x4x4(w[0], w[1], w[2], w[3]);
+            arkxmm::transpose_32x4x4(w[4], w[5], w[6], w[7]);
+            arkxmm::transpose_32x4x4(w[8], w[9], w[10], w[11]);
+            arkxmm::transpose_32x4x4(w[12], w[13], w[14], w[15]);
+
+            for (int k = 0; k < 4; k++)
+                for (int g = 0; g < 4; g++)
+                    store_key_stream<xor_input, non_temporal>(&output->operator[](k * 4 + g), &input->operator[](k * 4 + g), w[g * 4 + k]);
+        }
+
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        static void process_blocks(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        {
+            // non-temporal stores need aligned output.
+            if constexpr (non_temporal)
+                if (reinterpret_cast<uintptr_t>(output) % alignof(block_t) != 0)
+                    return process_blocks<rounds, counter_type, xor_input>(ctx, input, output, counter, block_count);
+
+            for (size_t i = 0; i < block_count; ++i, ++counter, ++input, ++output)
+            {
+                if constexpr (non_temporal && xor_input) prefetch_block_nta(input + 2);
+                process_block<rounds, counter_type, xor_input, non_temporal>(ctx, counter * 4, input, output);
+            }
+
+            if constexpr (non_temporal) arkxmm::store_fence();
+        }
+
+        // 1 block in horizontal layout. each vector holds one row of the state.
+        template <int rounds, class counter_type>
+        ARKXMM_API generate_block_1x(const context_t& ctx, counter_type first_block, std::byte* key_stream) noexcept
+        {
+            std::array<uint32_t, 1> w12, w13;
+            common::impl::get_block_counters(ctx, first_block, w12, w13);
+
+            const arkxmm::vu32x4 r0 = arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 0);
+            const arkxmm::vu32x4 r1 = arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 4);
+            const arkxmm::vu32x4 r2 = arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 8);
+            const arkxmm::vu32x4 r3 = arkxmm::u32x4(w12[0], w13[0], ctx.zero[14], ctx.zero[15]);
+
+            arkxmm::vu32x4 a = r0, b = r1, c = r2, d = r3;
+            for (int j = 0; j < rounds / 2; ++j)
+            {
+                quarter_round(a, b, c, d);
+                b = arkxmm::shuffle<1, 2, 3, 0>(b);
+                c = arkxmm::shuffle<2, 3, 0, 1>(c);
+                d = arkxmm::shuffle<3, 0, 1, 2>(d);
+                quarter_round(a, b, c, d);
+                b = arkxmm::shuffle<3, 0, 1, 2>(b);
+                c = arkxmm::shuffle<2, 3, 0, 1>(c);
+                d = arkxmm::shuffle<1, 2, 3, 0>(d);
+            }
+
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 0, a + r0);
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 16, b + r1);
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 32, c + r2);
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 48, d + r3);
+        }
+
+        // key stream of blocks [first_block, first_block + block_count), block_count <= 4.
+        template <int rounds, class counter_type>
+        static void generate_key_stream(const context_t& ctx, counter_type first_block, size_t block_count, std::byte* key_stream)
+        {
+            if (block_count == 1)
+                generate_block_1x<rounds, counter_type>(ctx, first_block, key_stream);
+            else
+                process_block<rounds, counter_type, false>(ctx, first_block, reinterpret_cast<const block_t*>(key_stream), reinterpret_cast<block_t*>(key_stream));
         }
 
+        template <int rounds, class counter_type, bool xor_input>
+        static void process_partial(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        {
+            return common::impl::process_partial<block_t, counter_type>(generate_key_stream<rounds, counter_type>, store_key_stream_partial<xor_input>, ctx, position, input, output, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
         static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
         {
-            return common::impl::process_stream<const context_t, block_t>(ctx, input, output, position, length);
+            if (length >= non_temporal_threshold().load(std::memory_order_relaxed))
+                return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            // key stream kernels never read input.
+            if (length >= non_temporal_threshold().load(std::memory_order_relaxed))
+                return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false, true>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            for (size_t i = 0; i < count; i++)
+                impl::process_stream<rounds, counter_type>(*jobs[i].ctx, jobs[i].input, jobs[i].output, jobs[i].position, jobs[i].length);
         }
     }
+}
+ARKANA_TARGET_REGION_END()
 
-#ifdef __AVX2__
+ARKANA_TARGET_REGION_BEGIN("avx2")
+namespace chacha20
+{
     // private impl
     namespace avx2::impl
     {
+        namespace arkxmm = arkana::xmm_avx2;
+
+        // output = input ^ key_stream, or output = key_stream when !xor_input.
+        // non_temporal: output must be aligned.
+        template <bool xor_input, bool non_temporal = false, class V>
+        ARKXMM_API store_key_stream(void* output, const void* input, V key_stream) noexcept
+        {
+            if constexpr (xor_input) key_stream ^= arkxmm::load_u<V>(input);
+            if constexpr (non_temporal) arkxmm::store_s<V>(output, key_stream);
+            else arkxmm::store_u<V>(output, key_stream);
+        }
+
+        // prefetches input that is read only once.
+        template <class T>
+        ARKXMM_API prefetch_block_nta(const T* p) noexcept
+        {
+            for (size_t i = 0; i < sizeof(T); i += 64)
+                arkxmm::prefetch_nta(reinterpret_cast<const std::byte*>(p) + i);
+        }
+
+        // store_key_stream for partial blocks: 32 or 16 bytes at once, then bytes.
+        template <bool xor_input>
+        static void store_key_stream_partial(std::byte* output, const std::byte* input, const std::byte* key_stream, size_t length) noexcept
+        {
+            for (; length >= 32; length -= 32, output += 32, input += 32, key_stream += 32)
+                store_key_stream<xor_input>(output, input, arkxmm::load_u<arkxmm::vu32x8>(key_stream));
+
+            if (length >= 16)
+            {
+                store_key_stream<xor_input>(output, input, arkxmm::load_u<arkxmm::vu32x4>(key_stream));
+                length -= 16, output += 16, input += 16, key_stream += 16;
+            }
+
+            for (size_t i = 0; i < length; i++)
+                output[i] = xor_input ? input[i] ^ key_stream[i] : key_stream[i];
+        }
+
         struct chacha_state
         {
             // sse
@@ -173,6 +714,12 @@ namespace chacha20
             s1 = chacha_shuffle_b(s1);
         }
 
+        template <class chacha_state, size_t... i>
+        ARKXMM_API chacha_double_rounds_parallel(chacha_state& s0, chacha_state& s1, std::index_sequence<i...>) noexcept
+        {
+            ((static_cast<void>(i), chacha_double_round_parallel(s0, s1)), ...);
+        }
+
         struct chacha_state2x
         {
             // avx
@@ -189,99 +736,1014 @@ namespace chacha20
 
         using block_t = chacha_state4x;
 
-        struct context_t
+        using chacha20::context_t;
+        using common::impl::prepare_context;
+
+        // horizontal layout
+        ARKXMM_API load_state2x(const context_t& ctx) noexcept -> chacha_state2x
         {
-            chacha_state2x zero;
-        };
+            return chacha_state2x{
+                u32x8(arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 0)),
+                u32x8(arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 4)),
+                u32x8(arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 8)),
+                u32x8(arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 12)),
+            };
+        }
 
-        static context_t prepare_context(const key* key, const nonce* nonce, counter_t initial_counter = 0)
+        // 1 block. (partial blocks)
+        template <int rounds, class counter_type>
+        ARKXMM_API generate_block_1x(const context_t& ctx, counter_type first_block, std::byte* key_stream) noexcept
         {
-            chacha_state state = {
-                arkxmm::u32x4(0x61707865, 0x3320646e, 0x79622d32, 0x6b206574),
-                arkxmm::load_u<arkxmm::vu32x4>(key->data() + 0),
-                arkxmm::load_u<arkxmm::vu32x4>(key->data() + 16),
-                arkxmm::u32x4(
-                    initial_counter,
-                    reinterpret_cast<const uint32_t*>(nonce)[0],
-                    reinterpret_cast<const uint32_t*>(nonce)[1],
-                    reinterpret_cast<const uint32_t*>(nonce)[2]),
+            std::array<uint32_t, 1> w12, w13;
+            common::impl::get_block_counters(ctx, first_block, w12, w13);
+
+            const chacha_state zero{
+                arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 0),
+                arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 4),
+                arkxmm::load_u<arkxmm::vu32x4>(ctx.zero.data() + 8),
+                arkxmm::u32x4(w12[0], w13[0], ctx.zero[14], ctx.zero[15]),
             };
 
-            chacha_state2x state2x{u32x8(state.r0), u32x8(state.r1), u32x8(state.r2), u32x8(state.r3)};
-            return context_t{state2x};
+            auto s = zero;
+            for (int j = 0; j < rounds / 2; ++j)
+                chacha_double_round(s);
+
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 0, s.r0 + zero.r0);
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 16, s.r1 + zero.r1);
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 32, s.r2 + zero.r2);
+            arkxmm::store_u<arkxmm::vu32x4>(key_stream + 48, s.r3 + zero.r3);
         }
 
-        ARKXMM_API process_block(const context_t& ctx, uint32_t counter, const block_t* input, block_t* output) noexcept
+        // 2 blocks. (partial blocks)
+        template <int rounds, class counter_type>
+        ARKXMM_API generate_block_2x(const context_t& ctx, counter_type first_block, std::byte* key_stream) noexcept
         {
-            auto s0 = ctx.zero;
-            auto s1 = ctx.zero;
+            std::array<uint32_t, 2> w12, w13;
+            common::impl::get_block_counters(ctx, first_block, w12, w13);
 
-            auto k = arkxmm::u32x8(counter * 4, 0, 0, 0);
-            auto init_s0r3 = s0.r3 += k + arkxmm::u32x8(0, 0, 0, 0, 1, 0, 0, 0);
-            auto init_s1r3 = s1.r3 += k + arkxmm::u32x8(2, 0, 0, 0, 3, 0, 0, 0);
+            auto zero = load_state2x(ctx);
+            zero.r3 = arkxmm::u32x8(w12[0], w13[0], ctx.zero[14], ctx.zero[15], w12[1], w13[1], ctx.zero[14], ctx.zero[15]);
 
-            // manual unrolling for msvc x86
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-            chacha_double_round_parallel(s0, s1);
-
-            s0.r0 += ctx.zero.r0;
-            s0.r1 += ctx.zero.r1;
-            s0.r2 += ctx.zero.r2;
-            s0.r3 += init_s0r3;
+            auto s = zero;
+            for (int j = 0; j < rounds / 2; ++j)
+                chacha_double_round(s);
 
-            s1.r0 += ctx.zero.r0;
-            s1.r1 += ctx.zero.r1;
-            s1.r2 += ctx.zero.r2;
-            s1.r3 += init_s1r3;
+            s.r0 += zero.r0;
+            s.r1 += zero.r1;
+            s.r2 += zero.r2;
+            s.r3 += zero.r3;
 
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state0.r0, arkxmm::load_u<arkxmm::vu32x8>(&input->state0.r0) ^ arkxmm::permute128<0, 2>(s0.r0, s0.r1));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state0.r1, arkxmm::load_u<arkxmm::vu32x8>(&input->state0.r1) ^ arkxmm::permute128<0, 2>(s0.r2, s0.r3));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state0.r2, arkxmm::load_u<arkxmm::vu32x8>(&input->state0.r2) ^ arkxmm::permute128<1, 3>(s0.r0, s0.r1));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state0.r3, arkxmm::load_u<arkxmm::vu32x8>(&input->state0.r3) ^ arkxmm::permute128<1, 3>(s0.r2, s0.r3));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state1.r0, arkxmm::load_u<arkxmm::vu32x8>(&input->state1.r0) ^ arkxmm::permute128<0, 2>(s1.r0, s1.r1));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state1.r1, arkxmm::load_u<arkxmm::vu32x8>(&input->state1.r1) ^ arkxmm::permute128<0, 2>(s1.r2, s1.r3));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state1.r2, arkxmm::load_u<arkxmm::vu32x8>(&input->state1.r2) ^ arkxmm::permute128<1, 3>(s1.r0, s1.r1));
-            arkxmm::store_u<arkxmm::vu32x8>(&output->state1.r3, arkxmm::load_u<arkxmm::vu32x8>(&input->state1.r3) ^ arkxmm::permute128<1, 3>(s1.r2, s1.r3));
+            arkxmm::store_u<arkxmm::vu32x8>(key_stream + 0, arkxmm::permute128<0, 2>(s.r0, s.r1));
+            arkxmm::store_u<arkxmm::vu32x8>(key_stream + 32, arkxmm::permute128<0, 2>(s.r2, s.r3));
+            arkxmm::store_u<arkxmm::vu32x8>(key_stream + 64, arkxmm::permute128<1, 3>(s.r0, s.r1));
+            arkxmm::store_u<arkxmm::vu32x8>(key_stream + 96, arkxmm::permute128<1, 3>(s.r2, s.r3));
         }
 
-        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        ARKXMM_API process_block(const context_t& ctx, counter_type first_block, const block_t* input, block_t* output) noexcept
         {
-            return common::impl::process_stream<const context_t, block_t>(ctx, input, output, position, length);
-        }
-    }
-#endif
+            const auto zero = load_state2x(ctx);
+            auto s0 = zero;
+            auto s1 = zero;
 
-    namespace ref
-    {
-        using impl::context_t;
+            arkxmm::vu32x8 init_s0r3, init_s1r3;
+            if constexpr (sizeof(counter_type) == sizeof(uint64_t))
+            {
+                std::array<uint32_t, 4> w12, w13;
+                common::impl::get_block_counters(ctx, first_block, w12, w13);
+                init_s0r3 = s0.r3 = arkxmm::u32x8(w12[0], w13[0], ctx.zero[14], ctx.zero[15], w12[1], w13[1], ctx.zero[14], ctx.zero[15]);
+                init_s1r3 = s1.r3 = arkxmm::u32x8(w12[2], w13[2], ctx.zero[14], ctx.zero[15], w12[3], w13[3], ctx.zero[14], ctx.zero[15]);
+            }
+            else
+            {
+                auto k = arkxmm::u32x8(first_block, 0, 0, 0);
+                init_s0r3 = s0.r3 += k + arkxmm::u32x8(0, 0, 0, 0, 1, 0, 0, 0);
+                init_s1r3 = s1.r3 += k + arkxmm::u32x8(2, 0, 0, 0, 3, 0, 0, 0);
+            }
+
+            // manual unrolling for msvc x86
+            chacha_double_rounds_parallel(s0, s1, std::make_index_sequence<rounds / 2>{});
+
+            s0.r0 += zero.r0;
+            s0.r1 += zero.r1;
+            s0.r2 += zero.r2;
+            s0.r3 += init_s0r3;
+
+            s1.r0 += zero.r0;
+            s1.r1 += zero.r1;
+            s1.r2 += zero.r2;
+            s1.r3 += init_s1r3;
+
+            store_key_stream<xor_input, non_temporal>(&output->state0.r0, &input->state0.r0, arkxmm::permute128<0, 2>(s0.r0, s0.r1));
+            store_key_stream<xor_input, non_temporal>(&output->state0.r1, &input->state0.r1, arkxmm::permute128<0, 2>(s0.r2, s0.r3));
+            store_key_stream<xor_input, non_temporal>(&output->state0.r2, &input->state0.r2, arkxmm::permute128<1, 3>(s0.r0, s0.r1));
+            store_key_stream<xor_input, non_temporal>(&output->state0.r3, &input->state0.r3, arkxmm::permute128<1, 3>(s0.r2, s0.r3));
+            store_key_stream<xor_input, non_temporal>(&output->state1.r0, &input->state1.r0, arkxmm::permute128<0, 2>(s1.r0, s1.r1));
+            store_key_stream<xor_input, non_temporal>(&output->state1.r1, &input->state1.r1, arkxmm::permute128<0, 2>(s1.r2, s1.r3));
+            store_key_stream<xor_input, non_temporal>(&output->state1.r2, &input->state1.r2, arkxmm::permute128<1, 3>(s1.r0, s1.r1));
+            store_key_stream<xor_input, non_temporal>(&output->state1.r3, &input->state1.r3, arkxmm::permute128<1, 3>(s1.r2, s1.r3));
+        }
+
+        ARKXMM_API quarter_round(arkxmm::vu32x8& a, arkxmm::vu32x8& b, arkxmm::vu32x8& c, arkxmm::vu32x8& d) noexcept
+        {
+            d = byte_rotr2(d ^= a += b);
+            b = rotl(b ^= c += d, 12);
+            d = byte_rotr3(d ^= a += b);
+            b = rotl(b ^= c += d, 7);
+        }
+
+        using chacha_state8x_vertical = std::array<arkxmm::vu32x8, 16>;
+
+        template <int rounds>
+        ARKXMM_API chacha_rounds_vertical(chacha_state8x_vertical& w) noexcept
+        {
+            for (int j = 0; j < rounds / 2; ++j)
+            {
+                quarter_round(w[0], w[4], w[8], w[12]);
+                quarter_round(w[1], w[5], w[9], w[13]);
+                quarter_round(w[2], w[6], w[10], w[14]);
+                quarter_round(w[3], w[7], w[11], w[15]);
+                quarter_round(w[0], w[5], w[10], w[15]);
+                quarter_round(w[1], w[6], w[11], w[12]);
+                quarter_round(w[2], w[7], w[8], w[13]);
+                quarter_round(w[3], w[4], w[9], w[14]);
+            }
+        }
+
+        // initial state of 8 blocks in vertical layout. lane j holds block (first_block + j).
+        template <class counter_type>
+        ARKXMM_API load_state8x_vertical(const context_t& ctx, counter_type first_block) noexcept -> chacha_state8x_vertical
+        {
+            chacha_state8x_vertical w;
+            for (int i = 0; i < 16; i++)
+                w[i] = arkxmm::broadcast<arkxmm::vu32x8>(ctx.zero[i]);
+
+            if constexpr (sizeof(counter_type) == sizeof(uint64_t))
+            {
+                std::array<uint32_t, 8> w12, w13;
+                common::impl::get_block_counters(ctx, first_block, w12, w13);
+                w[12] = arkxmm::load_u<arkxmm::vu32x8>(w12.data());
+                w[13] = arkxmm::load_u<arkxmm::vu32x8>(w13.data());
+            }
+            else
+                w[12] += arkxmm::broadcast<arkxmm::vu32x8>(first_block) + arkxmm::u32x8(0, 1, 2, 3, 4, 5, 6, 7);
+
+            return w;
+        }
+
+        // adds initial state (words 12..13 from init_w12/init_w13, others from ctx) and writes 8 blocks (512 bytes).
+        template <bool xor_input, bool non_temporal>
+        ARKXMM_API store_state8x_vertical(const context_t& ctx, chacha_state8x_vertical& w, arkxmm::vu32x8 init_w12, arkxmm::vu32x8 init_w13, const void* input, void* output) noexcept
+        {
+            for (int i = 0; i < 16; i++)
+                w[i] += i == 12 ? init_w12 : i == 13 ? init_w13 : arkxmm::broadcast<arkxmm::vu32x8>(ctx.zero[i]);
+
+            // w[4g+k] = { block k: words 4g..4g+3 | block 4+k: words 4g..4g+3 }
+            arkxmm::transpose_32x4x4(w[0], w[1], w[2], w[3]);
+            arkxmm::transpose_32x4x4(w[4], w[5], w[6], w[7]);
+            arkxmm::transpose_32x4x4(w[8], w[9], w[10], w[11]);
+            arkxmm::transpose_32x4x4(w[12], w[13], w[14], w[15]);
+
+            auto in = static_cast<const arkxmm::vu32x8*>(input);
+            auto out = static_cast<arkxmm::vu32x8*>(output);
+            for (int k = 0; k < 4; k++)
+            {
+                store_key_stream<xor_input, non_temporal>(out + k * 2 + 0, in + k * 2 + 0, arkxmm::permute128<0, 2>(w[k + 0], w[k + 4]));
+                store_key_stream<xor_input, non_temporal>(out + k * 2 + 1, in + k * 2 + 1, arkxmm::permute128<0, 2>(w[k + 8], w[k + 12]));
+                store_key_stream<xor_input, non_temporal>(out + k * 2 + 8, in + k * 2 + 8, arkxmm::permute128<1, 3>(w[k + 0], w[k + 4]));
+                store_key_stream<xor_input, non_temporal>(out + k * 2 + 9, in + k * 2 + 9, arkxmm::permute128<1, 3>(w[k + 8], w[k + 12]));
+            }
+        }
+
+        // processes 8 blocks (2 block_t) at once in vertical layout. each vector holds one state word of 8 blocks.
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        ARKXMM_API process_block_vertical(const context_t& ctx, counter_type first_block, const block_t* input, block_t* output) noexcept
+        {
+            chacha_state8x_vertical w = load_state8x_vertical(ctx, first_block);
+            const arkxmm::vu32x8 init_w12 = w[12], init_w13 = w[13];
+
+            chacha_rounds_vertical<rounds>(w);
+
+            store_state8x_vertical<xor_input, non_temporal>(ctx, w, init_w12, init_w13, input, output);
+        }
+
+        // hybrid kernel: processes 9 blocks (576 bytes) at once.
+        // blocks first_block..+7 run on vector ALUs in vertical layout, and block first_block+8 runs on scalar ALUs,
+        // the scalar quarter rounds interleaved into the vector double rounds.
+        template <int rounds, class counter_type, bool xor_input>
+        ARKXMM_API process_block_hybrid(const context_t& ctx, counter_type first_block, const std::byte* input, std::byte* output) noexcept
+        {
+            chacha_state8x_vertical w = load_state8x_vertical(ctx, first_block);
+            const arkxmm::vu32x8 init_w12 = w[12], init_w13 = w[13];
+
+            std::array<uint32_t, 1> x12, x13;
+            common::impl::get_block_counters(ctx, static_cast<counter_type>(first_block + 8), x12, x13);
+            chacha20::chacha_state x = ctx.zero;
+            x[12] = x12[0];
+            x[13] = x13[0];
+
+            for (int j = 0; j < rounds / 2; ++j)
+            {
+                quarter_round(w[0], w[4], w[8], w[12]);
+                common::impl::quarter_round(x[0], x[4], x[8], x[12]);
+                quarter_round(w[1], w[5], w[9], w[13]);
+                common::impl::quarter_round(x[1], x[5], x[9], x[13]);
+                quarter_round(w[2], w[6], w[10], w[14]);
+                common::impl::quarter_round(x[2], x[6], x[10], x[14]);
+                quarter_round(w[3], w[7], w[11], w[15]);
+                common::impl::quarter_round(x[3], x[7], x[11], x[15]);
+                quarter_round(w[0], w[5], w[10], w[15]);
+                common::impl::quarter_round(x[0], x[5], x[10], x[15]);
+                quarter_round(w[1], w[6], w[11], w[12]);
+                common::impl::quarter_round(x[1], x[6], x[11], x[12]);
+                quarter_round(w[2], w[7], w[8], w[13]);
+                common::impl::quarter_round(x[2], x[7], x[8], x[13]);
+                quarter_round(w[3], w[4], w[9], w[14]);
+                common::impl::quarter_round(x[3], x[4], x[9], x[14]);
+            }
+
+            store_state8x_vertical<xor_input, false>(ctx, w, init_w12, init_w13, input, output);
+
+            for (int i = 0; i < 16; i++)
+            {
+                uint32_t k = x[i] + (i == 12 ? x12[0] : i == 13 ? x13[0] : ctx.zero[i]);
+                if constexpr (xor_input)
+                {
+                    uint32_t t;
+                    std::memcpy(&t, input + 512 + i * 4, 4);
+                    k ^= t;
+                }
+                std::memcpy(output + 512 + i * 4, &k, 4);
+            }
+        }
+
+        // key stream of blocks [first_block, first_block + block_count), block_count <= 4.
+        template <int rounds, class counter_type>
+        static void generate_key_stream(const context_t& ctx, counter_type first_block, size_t block_count, std::byte* key_stream)
+        {
+            if (block_count == 1)
+                generate_block_1x<rounds, counter_type>(ctx, first_block, key_stream);
+            else if (block_count == 2)
+                generate_block_2x<rounds, counter_type>(ctx, first_block, key_stream);
+            else
+                process_block<rounds, counter_type, false>(ctx, first_block, reinterpret_cast<const block_t*>(key_stream), reinterpret_cast<block_t*>(key_stream));
+        }
+
+        // processes blocks with the hybrid kernel. (block_count: in block_t)
+        template <int rounds, class counter_type, bool xor_input>
+        static void process_blocks_hybrid(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        {
+            auto in = reinterpret_cast<const std::byte*>(input);
+            auto out = reinterpret_cast<std::byte*>(output);
+            counter_type first_block = counter * 4;
+            size_t blocks = block_count * 4;
+
+            for (; blocks >= 9; blocks -= 9, first_block += 9, in += 576, out += 576)
+                process_block_hybrid<rounds, counter_type, xor_input>(ctx, first_block, in, out);
+
+            // remainder: 0..8 blocks.
+            if (blocks >= 8)
+            {
+                process_block_vertical<rounds, counter_type, xor_input>(ctx, first_block, reinterpret_cast<const block_t*>(in), reinterpret_cast<block_t*>(out));
+                blocks -= 8, first_block += 8, in += 512, out += 512;
+            }
+            if (blocks >= 4)
+            {
+                process_block<rounds, counter_type, xor_input>(ctx, first_block, reinterpret_cast<const block_t*>(in), reinterpret_cast<block_t*>(out));
+                blocks -= 4, first_block += 4, in += 256, out += 256;
+            }
+            if (blocks)
+            {
+                alignas(32) std::byte key_stream[sizeof(block_t)];
+                generate_key_stream<rounds, counter_type>(ctx, first_block, blocks, key_stream);
+                store_key_stream_partial<xor_input>(out, in, key_stream, blocks * 64);
+            }
+        }
+
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        static void process_blocks(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        {
+            // non-temporal stores need aligned output.
+            if constexpr (non_temporal)
+                if (reinterpret_cast<uintptr_t>(output) % alignof(block_t) != 0)
+                    return process_blocks<rounds, counter_type, xor_input>(ctx, input, output, counter, block_count);
+
+            // runs of 512 bytes or more: vertical kernel, 8 blocks at once.
+            for (; block_count >= 2; block_count -= 2, counter += 2, input += 2, output += 2)
+            {
+                if constexpr (non_temporal && xor_input) prefetch_block_nta(input + 4), prefetch_block_nta(input + 5);
+                process_block_vertical<rounds, counter_type, xor_input, non_temporal>(ctx, counter * 4, input, output);
+            }
+
+            // short runs and remainder: horizontal kernel, 4 blocks at once.
+            if (block_count)
+                process_block<rounds, counter_type, xor_input, non_temporal>(ctx, counter * 4, input, output);
+
+            if constexpr (non_temporal) arkxmm::store_fence();
+        }
+
+        template <int rounds, class counter_type, bool xor_input>
+        static void process_partial(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        {
+            return common::impl::process_partial<block_t, counter_type>(generate_key_stream<rounds, counter_type>, store_key_stream_partial<xor_input>, ctx, position, input, output, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            if (length >= non_temporal_threshold().load(std::memory_order_relaxed))
+                return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            // key stream kernels never read input.
+            if (length >= non_temporal_threshold().load(std::memory_order_relaxed))
+                return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false, true>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+        }
+
+        // hybrid kernel variants. not dispatched: slower than process_stream on the CPUs measured so far
+        // (vector and scalar states together exceed the register file), kept for benchmarking on other cores.
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_stream_hybrid(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return common::impl::process_stream<block_t, counter_type>(process_blocks_hybrid<rounds, counter_type, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream_hybrid(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            return common::impl::process_stream<block_t, counter_type>(process_blocks_hybrid<rounds, counter_type, false>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+        }
+
+        // multi-buffer: 8 lane blocks at once, each from its own context and position.
+        template <int rounds, class counter_type>
+        static void process_lane_blocks(const common::impl::lane_block* blocks, size_t count) noexcept
+        {
+            // unused lanes repeat lane 0, and are not stored.
+            std::array<chacha20::chacha_state, 8> init;
+            for (size_t j = 0; j < 8; j++)
+                init[j] = common::impl::get_lane_state<counter_type>(blocks[j < count ? j : 0]);
+
+            // w[4g+k] = { lane k: words 4g..4g+3 | lane 4+k: words 4g..4g+3 } -> vertical layout
+            chacha_state8x_vertical w;
+            for (int g = 0; g < 4; g++)
+            {
+                for (int k = 0; k < 4; k++)
+                    w[4 * g + k] = arkxmm::u32x8(arkxmm::load_u<arkxmm::vu32x4>(init[k].data() + 4 * g), arkxmm::load_u<arkxmm::vu32x4>(init[k + 4].data() + 4 * g));
+                arkxmm::transpose_32x4x4(w[4 * g + 0], w[4 * g + 1], w[4 * g + 2], w[4 * g + 3]);
+            }
+
+            const chacha_state8x_vertical x = w;
+            chacha_rounds_vertical<rounds>(w);
+            for (int i = 0; i < 16; i++)
+                w[i] += x[i];
+
+            // w[4g+k] = { lane k: words 4g..4g+3 | lane 4+k: words 4g..4g+3 }
+            arkxmm::transpose_32x4x4(w[0], w[1], w[2], w[3]);
+            arkxmm::transpose_32x4x4(w[4], w[5], w[6], w[7]);
+            arkxmm::transpose_32x4x4(w[8], w[9], w[10], w[11]);
+            arkxmm::transpose_32x4x4(w[12], w[13], w[14], w[15]);
+
+            for (size_t j = 0; j < count; j++)
+            {
+                const auto& b = blocks[j];
+                const int k = static_cast<int>(j % 4);
+                std::array<arkxmm::vu32x4, 4> key_stream;
+                for (int g = 0; g < 4; g++)
+                    key_stream[g] = j < 4 ? arkxmm::lower128(w[4 * g + k]) : arkxmm::higher128(w[4 * g + k]);
+
+                if (b.length == 64)
+                {
+                    for (int g = 0; g < 4; g++)
+                        store_key_stream<true>(b.output + 16 * g, b.input + 16 * g, key_stream[g]);
+                }
+                else
+                {
+                    store_key_stream_partial<true>(b.output, b.input, reinterpret_cast<const std::byte*>(key_stream.data()) + b.offset, b.length);
+                }
+            }
+        }
+
+        template <int rounds, class counter_type>
+        static void process_bulk(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        {
+            process_blocks<rounds, counter_type, true>(ctx, reinterpret_cast<const block_t*>(input), reinterpret_cast<block_t*>(output), static_cast<counter_type>(position / sizeof(block_t)), length / sizeof(block_t));
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            // runs for the vertical kernel go to process_blocks.
+            common::impl::lane_block_iterator<block_t, sizeof(block_t) * 2, decltype(&process_bulk<rounds, counter_type>)> it(jobs, count, process_bulk<rounds, counter_type>);
+            std::array<common::impl::lane_block, 8> blocks;
+            while (size_t n = it.next(blocks))
+                process_lane_blocks<rounds, counter_type>(blocks.data(), n);
+        }
+
+        // derives 8 subkeys at once. lane j processes keys[j] and nonces[j].
+        template <int rounds>
+        static void hchacha_blocks(const key* keys, const hnonce* nonces, key* subkeys, size_t count)
+        {
+            for (; count >= 8; count -= 8, keys += 8, nonces += 8, subkeys += 8)
+            {
+                chacha_state8x_vertical w;
+                for (int i = 0; i < 4; i++)
+                    w[i] = arkxmm::broadcast<arkxmm::vu32x8>(common::impl::sigma[i]);
+
+                // w[4g+k] = { item k: words 4g..4g+3 | item 4+k: words 4g..4g+3 }
+                for (int k = 0; k < 4; k++)
+                {
+                    w[4 + k] = arkxmm::u32x8(arkxmm::load_u<arkxmm::vu32x4>(keys[k].data() + 0), arkxmm::load_u<arkxmm::vu32x4>(keys[k + 4].data() + 0));
+                    w[8 + k] = arkxmm::u32x8(arkxmm::load_u<arkxmm::vu32x4>(keys[k].data() + 16), arkxmm::load_u<arkxmm::vu32x4>(keys[k + 4].data() + 16));
+                    w[12 + k] = arkxmm::u32x8(arkxmm::load_u<arkxmm::vu32x4>(nonces[k].data()), arkxmm::load_u<arkxmm::vu32x4>(nonces[k + 4].data()));
+                }
+
+                arkxmm::transpose_32x4x4(w[4], w[5], w[6], w[7]);
+                arkxmm::transpose_32x4x4(w[8], w[9], w[10], w[11]);
+                arkxmm::transpose_32x4x4(w[12], w[13], w[14], w[15]);
+
+                chacha_rounds_vertical<rounds>(w);
+
+                arkxmm::transpose_32x4x4(w[0], w[1], w[2], w[3]);
+                arkxmm::transpose_32x4x4(w[12], w[13], w[14], w[15]);
+
+                for (int k = 0; k < 4; k++)
+                {
+                    arkxmm::store_u<arkxmm::vu32x4>(subkeys[k].data() + 0, arkxmm::lower128(w[k]));
+                    arkxmm::store_u<arkxmm::vu32x4>(subkeys[k].data() + 16, arkxmm::lower128(w[12 + k]));
+                    arkxmm::store_u<arkxmm::vu32x4>(subkeys[k + 4].data() + 0, arkxmm::higher128(w[k]));
+                    arkxmm::store_u<arkxmm::vu32x4>(subkeys[k + 4].data() + 16, arkxmm::higher128(w[12 + k]));
+                }
+            }
+
+            // remainder
+            ref::impl::hchacha_blocks<rounds>(keys, nonces, subkeys, count);
+        }
+    }
+}
+ARKANA_TARGET_REGION_END()
+
+ARKANA_TARGET_REGION_BEGIN("avx512f,avx512vl")
+namespace chacha20
+{
+    // private impl
+    namespace avx512::impl
+    {
+        namespace arkxmm = arkana::xmm_avx512;
+
+        // output = input ^ key_stream, or output = key_stream when !xor_input.
+        // non_temporal: output must be aligned.
+        template <bool xor_input, bool non_temporal = false, class V>
+        ARKXMM_API store_key_stream(void* output, const void* input, V key_stream) noexcept
+        {
+            if constexpr (xor_input) key_stream ^= arkxmm::load_u<V>(input);
+            if constexpr (non_temporal) arkxmm::store_s<V>(output, key_stream);
+            else arkxmm::store_u<V>(output, key_stream);
+        }
+
+        // prefetches input that is read only once.
+        template <class T>
+        ARKXMM_API prefetch_block_nta(const T* p) noexcept
+        {
+            for (size_t i = 0; i < sizeof(T); i += 64)
+                arkxmm::prefetch_nta(reinterpret_cast<const std::byte*>(p) + i);
+        }
+
+        // store_key_stream for partial blocks: 64 bytes at once, then one masked store by 4 bytes, then bytes.
+        template <bool xor_input>
+        static void store_key_stream_partial(std::byte* output, const std::byte* input, const std::byte* key_stream, size_t length) noexcept
+        {
+            for (; length >= 64; length -= 64, output += 64, input += 64, key_stream += 64)
+                store_key_stream<xor_input>(output, input, arkxmm::load_u<arkxmm::vu32x16>(key_stream));
+
+            if (const size_t words = length / 4)
+            {
+                // masked-out lanes are neither read nor written.
+                const auto mask = static_cast<__mmask16>((1u << words) - 1);
+                __m512i ks = _mm512_maskz_loadu_epi32(mask, key_stream);
+                if constexpr (xor_input) ks = _mm512_xor_si512(ks, _mm512_maskz_loadu_epi32(mask, input));
+                _mm512_mask_storeu_epi32(output, mask, ks);
+                length -= words * 4, output += words * 4, input += words * 4, key_stream += words * 4;
+            }
+
+            for (size_t i = 0; i < length; i++)
+                output[i] = xor_input ? input[i] ^ key_stream[i] : key_stream[i];
+        }
+
+        // 16 blocks (1 KiB) at once. each vector holds one state word of 16 blocks.
+        using block_t = std::array<arkxmm::vu32x16, 16>;
+
+        using chacha20::context_t;
+        using common::impl::prepare_context;
+
+        ARKXMM_API quarter_round(arkxmm::vu32x16& a, arkxmm::vu32x16& b, arkxmm::vu32x16& c, arkxmm::vu32x16& d) noexcept
+        {
+            d = arkxmm::rotl<16>(d ^= a += b);
+            b = arkxmm::rotl<12>(b ^= c += d);
+            d = arkxmm::rotl<8>(d ^= a += b);
+            b = arkxmm::rotl<7>(b ^= c += d);
+        }
+
+        template <int rounds>
+        ARKXMM_API chacha_rounds(block_t& w) noexcept
+        {
+            for (int j = 0; j < rounds / 2; ++j)
+            {
+                quarter_round(w[0], w[4], w[8], w[12]);
+                quarter_round(w[1], w[5], w[9], w[13]);
+                quarter_round(w[2], w[6], w[10], w[14]);
+                quarter_round(w[3], w[7], w[11], w[15]);
+                quarter_round(w[0], w[5], w[10], w[15]);
+                quarter_round(w[1], w[6], w[11], w[12]);
+                quarter_round(w[2], w[7], w[8], w[13]);
+                quarter_round(w[3], w[4], w[9], w[14]);
+            }
+        }
+
+        // w[i] lane j <-> w[j] lane i
+        ARKXMM_API transpose_32x16x16(block_t& w) noexcept
+        {
+            arkxmm::transpose_32x4x4(w[0], w[1], w[2], w[3]);
+            arkxmm::transpose_32x4x4(w[4], w[5], w[6], w[7]);
+            arkxmm::transpose_32x4x4(w[8], w[9], w[10], w[11]);
+            arkxmm::transpose_32x4x4(w[12], w[13], w[14], w[15]);
+            arkxmm::transpose_128x4x4(w[0], w[4], w[8], w[12]);
+            arkxmm::transpose_128x4x4(w[1], w[5], w[9], w[13]);
+            arkxmm::transpose_128x4x4(w[2], w[6], w[10], w[14]);
+            arkxmm::transpose_128x4x4(w[3], w[7], w[11], w[15]);
+        }
+
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        ARKXMM_API process_block(const context_t& ctx, counter_type first_block, const block_t* input, block_t* output) noexcept
+        {
+            block_t w;
+            for (int i = 0; i < 16; i++)
+                w[i] = arkxmm::broadcast<arkxmm::vu32x16>(ctx.zero[i]);
+
+            // lane j processes block (first_block + j).
+            arkxmm::vu32x16 init_w12, init_w13 = w[13];
+            if constexpr (sizeof(counter_type) == sizeof(uint64_t))
+            {
+                std::array<uint32_t, 16> w12, w13;
+                common::impl::get_block_counters(ctx, first_block, w12, w13);
+                init_w12 = w[12] = arkxmm::load_u<arkxmm::vu32x16>(w12.data());
+                init_w13 = w[13] = arkxmm::load_u<arkxmm::vu32x16>(w13.data());
+            }
+            else
+                init_w12 = w[12] += arkxmm::broadcast<arkxmm::vu32x16>(first_block) + arkxmm::from_values<arkxmm::vu32x16>(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+            chacha_rounds<rounds>(w);
+
+            for (int i = 0; i < 16; i++)
+                w[i] += i == 12 ? init_w12 : i == 13 ? init_w13 : arkxmm::broadcast<arkxmm::vu32x16>(ctx.zero[i]);
+
+            // w[i] lane j = word i of block j -> w[i] = block i
+            transpose_32x16x16(w);
+
+            for (int i = 0; i < 16; i++)
+                store_key_stream<xor_input, non_temporal>(&output->operator[](i), &input->operator[](i), w[i]);
+        }
+
+        template <int rounds, class counter_type, bool xor_input, bool non_temporal = false>
+        static void process_blocks(const context_t& ctx, const block_t* input, block_t* output, counter_type counter, size_t block_count)
+        {
+            // non-temporal stores need aligned output.
+            if constexpr (non_temporal)
+                if (reinterpret_cast<uintptr_t>(output) % alignof(block_t) != 0)
+                    return process_blocks<rounds, counter_type, xor_input>(ctx, input, output, counter, block_count);
+
+            for (size_t i = 0; i < block_count; ++i, ++counter, ++input, ++output)
+            {
+                if constexpr (non_temporal && xor_input) prefetch_block_nta(input + 2);
+                process_block<rounds, counter_type, xor_input, non_temporal>(ctx, counter * 16, input, output);
+            }
+
+            if constexpr (non_temporal) arkxmm::store_fence();
+        }
+
+        // key stream of blocks [first_block, first_block + block_count), block_count <= 16.
+        template <int rounds, class counter_type>
+        static void generate_key_stream(const context_t& ctx, counter_type first_block, size_t block_count, std::byte* key_stream)
+        {
+            // up to 4 blocks: narrower kernels. (avx512f implies avx2)
+            if (block_count <= 4)
+                avx2::impl::generate_key_stream<rounds, counter_type>(ctx, first_block, block_count, key_stream);
+            else
+                process_block<rounds, counter_type, false>(ctx, first_block, reinterpret_cast<const block_t*>(key_stream), reinterpret_cast<block_t*>(key_stream));
+        }
+
+        template <int rounds, class counter_type, bool xor_input>
+        static void process_partial(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        {
+            return common::impl::process_partial<block_t, counter_type>(generate_key_stream<rounds, counter_type>, store_key_stream_partial<xor_input>, ctx, position, input, output, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            if (length >= non_temporal_threshold().load(std::memory_order_relaxed))
+                return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, true>, process_partial<rounds, counter_type, true>, ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            // key stream kernels never read input.
+            if (length >= non_temporal_threshold().load(std::memory_order_relaxed))
+                return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false, true>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+
+            return common::impl::process_stream<block_t, counter_type>(process_blocks<rounds, counter_type, false>, process_partial<rounds, counter_type, false>, ctx, output, output, position, length);
+        }
+
+        // multi-buffer: 16 lane blocks at once, each from its own context and position.
+        template <int rounds, class counter_type>
+        static void process_lane_blocks(const common::impl::lane_block* blocks, size_t count) noexcept
+        {
+            // w[j] = initial state of lane j. unused lanes repeat lane 0, and are not stored.
+            block_t w;
+            for (size_t j = 0; j < 16; j++)
+            {
+                const auto init = common::impl::get_lane_state<counter_type>(blocks[j < count ? j : 0]);
+                w[j] = arkxmm::load_u<arkxmm::vu32x16>(init.data());
+            }
+
+            transpose_32x16x16(w); // -> vertical layout
+            const block_t x = w;
+            chacha_rounds<rounds>(w);
+            for (int i = 0; i < 16; i++)
+                w[i] += x[i];
+            transpose_32x16x16(w); // -> w[j] = key stream of lane j
+
+            for (size_t j = 0; j < count; j++)
+            {
+                const auto& b = blocks[j];
+                if (b.length == 64)
+                {
+                    store_key_stream<true>(b.output, b.input, w[j]);
+                }
+                else
+                {
+                    alignas(64) std::byte key_stream[64];
+                    arkxmm::store_u<arkxmm::vu32x16>(key_stream, w[j]);
+                    store_key_stream_partial<true>(b.output, b.input, key_stream + b.offset, b.length);
+                }
+            }
+        }
+
+        template <int rounds, class counter_type>
+        static void process_bulk(const context_t& ctx, position_t position, const std::byte* input, std::byte* output, size_t length)
+        {
+            process_blocks<rounds, counter_type, true>(ctx, reinterpret_cast<const block_t*>(input), reinterpret_cast<block_t*>(output), static_cast<counter_type>(position / sizeof(block_t)), length / sizeof(block_t));
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            // runs of whole block_t go to process_blocks.
+            common::impl::lane_block_iterator<block_t, sizeof(block_t), decltype(&process_bulk<rounds, counter_type>)> it(jobs, count, process_bulk<rounds, counter_type>);
+            std::array<common::impl::lane_block, 16> blocks;
+            while (size_t n = it.next(blocks))
+                process_lane_blocks<rounds, counter_type>(blocks.data(), n);
+        }
+    }
+}
+ARKANA_TARGET_REGION_END()
+#endif
+
+namespace chacha20
+{
+    namespace ref
+    {
+        using impl::context_t;
+        using impl::prepare_context;
+        using impl::process_stream;
+        using impl::generate_keystream;
+        using impl::process_streams;
+
+        // for engine<backend, rounds, counter_type>
+        struct backend
+        {
+            static const char* name() noexcept { return "ref"; }
+            template <int rounds, class counter_type> static constexpr auto process_stream = impl::process_stream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto generate_keystream = impl::generate_keystream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto process_streams = impl::process_streams<rounds, counter_type>;
+            template <int rounds> static constexpr auto hchacha_blocks = impl::hchacha_blocks<rounds>;
+        };
+    }
+
+#if defined(ARKANA_CHACHA20_VEC_AVAILABLE)
+    namespace vec
+    {
+        using impl::context_t;
+        using impl::prepare_context;
+        using impl::process_stream;
+        using impl::generate_keystream;
+        using impl::process_streams;
+
+        // for engine<backend, rounds, counter_type>
+        struct backend
+        {
+            static const char* name() noexcept { return "vec"; }
+            template <int rounds, class counter_type> static constexpr auto process_stream = impl::process_stream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto generate_keystream = impl::generate_keystream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto process_streams = impl::process_streams<rounds, counter_type>;
+            template <int rounds> static constexpr auto hchacha_blocks = ref::impl::hchacha_blocks<rounds>;
+        };
+    }
+#endif
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+    namespace sse
+    {
+        using impl::context_t;
         using impl::prepare_context;
         using impl::process_stream;
+        using impl::generate_keystream;
+        using impl::process_streams;
+
+        // for engine<backend, rounds, counter_type>
+        struct backend
+        {
+            static const char* name() noexcept { return "sse"; }
+            template <int rounds, class counter_type> static constexpr auto process_stream = impl::process_stream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto generate_keystream = impl::generate_keystream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto process_streams = impl::process_streams<rounds, counter_type>;
+            template <int rounds> static constexpr auto hchacha_blocks = ref::impl::hchacha_blocks<rounds>;
+        };
     }
 
-#ifdef __AVX2__
     namespace avx2
     {
         using impl::context_t;
         using impl::prepare_context;
         using impl::process_stream;
+        using impl::generate_keystream;
+        using impl::process_streams;
+        using impl::process_stream_hybrid;
+        using impl::generate_keystream_hybrid;
+
+        // for engine<backend, rounds, counter_type>
+        struct backend
+        {
+            static const char* name() noexcept { return "avx2"; }
+            template <int rounds, class counter_type> static constexpr auto process_stream = impl::process_stream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto generate_keystream = impl::generate_keystream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto process_streams = impl::process_streams<rounds, counter_type>;
+            template <int rounds> static constexpr auto hchacha_blocks = impl::hchacha_blocks<rounds>;
+        };
+    }
+
+    namespace avx512
+    {
+        using impl::context_t;
+        using impl::prepare_context;
+        using impl::process_stream;
+        using impl::generate_keystream;
+        using impl::process_streams;
+
+        // for engine<backend, rounds, counter_type>
+        struct backend
+        {
+            static const char* name() noexcept { return "avx512"; }
+            template <int rounds, class counter_type> static constexpr auto process_stream = impl::process_stream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto generate_keystream = impl::generate_keystream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto process_streams = impl::process_streams<rounds, counter_type>;
+            template <int rounds> static constexpr auto hchacha_blocks = avx2::impl::hchacha_blocks<rounds>;
+        };
     }
 #endif
 
-#ifndef __AVX2__
-    using ref::context_t;
-    using ref::prepare_context;
-    using ref::process_stream;
-#else
-    using avx2::context_t;
-    using avx2::prepare_context;
-    using avx2::process_stream;
+    // ChaCha with backend, rounds and counter width selected at compile time. (no indirect calls)
+    // e.g. engine<avx2::backend, 8, counter64_t>::process_stream(ctx, input, output, position, length);
+    template <class backend, int rounds = 20, class counter_type = counter_t>
+    struct engine
+    {
+        static_assert(rounds > 0 && rounds % 2 == 0, "rounds must be a positive even number.");
+        static_assert(sizeof(counter_type) == sizeof(uint32_t) || sizeof(counter_type) == sizeof(uint64_t), "counter must be 32-bit or 64-bit.");
+
+        // 12-byte nonce with 32-bit counter, or 8-byte nonce with 64-bit counter. (see ctr64)
+        using nonce_type = std::conditional_t<sizeof(counter_type) == sizeof(uint64_t), nonce64, nonce>;
+
+        static const char* name() noexcept { return backend::name(); }
+
+        static context_t prepare_context(const key* key, const nonce_type* nonce, counter_type initial_counter = 0)
+        {
+            return common::impl::prepare_context(key, nonce, initial_counter);
+        }
+
+        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return backend::template process_stream<rounds, counter_type>(ctx, input, output, position, length);
+        }
+
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            return backend::template generate_keystream<rounds, counter_type>(ctx, output, position, length);
+        }
+
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            return backend::template process_streams<rounds, counter_type>(jobs, count);
+        }
+
+        static void hchacha_blocks(const key* keys, const hnonce* nonces, key* subkeys, size_t count)
+        {
+            return backend::template hchacha_blocks<rounds>(keys, nonces, subkeys, count);
+        }
+    };
+
+    // private impl
+    namespace dispatch::impl
+    {
+        using process_stream_function = void(const context_t& ctx, const void* input, void* output, position_t position, size_t length);
+        using generate_keystream_function = void(const context_t& ctx, void* output, position_t position, size_t length);
+        using hchacha_blocks_function = void(const key* keys, const hnonce* nonces, key* subkeys, size_t count);
+        using process_streams_function = void(const stream_job* jobs, size_t count);
+
+        struct function_table
+        {
+            const char* name;
+            process_stream_function* process_stream;
+            generate_keystream_function* generate_keystream;
+            hchacha_blocks_function* hchacha_blocks;
+            process_streams_function* process_streams;
+        };
+
+        template <class engine>
+        static function_table make_function_table() noexcept
+        {
+            return {engine::name(), engine::process_stream, engine::generate_keystream, engine::hchacha_blocks, engine::process_streams};
+        }
+
+        template <int rounds, class counter_type>
+        static function_table resolve_function_table() noexcept
+        {
+#if defined(ARKANA_CPU_FEATURES_X86)
+            const auto& cpu = arkana::cpu_features::get();
+            if (cpu.avx512f && cpu.avx512vl) return make_function_table<engine<avx512::backend, rounds, counter_type>>();
+            if (cpu.avx2) return make_function_table<engine<avx2::backend, rounds, counter_type>>();
+            if (cpu.ssse3) return make_function_table<engine<sse::backend, rounds, counter_type>>();
+#endif
+#if defined(ARKANA_CHACHA20_VEC_AVAILABLE)
+            return make_function_table<engine<vec::backend, rounds, counter_type>>();
 #endif
+            return make_function_table<engine<ref::backend, rounds, counter_type>>();
+        }
+
+        template <int rounds, class counter_type = counter_t>
+        static const function_table& get_function_table() noexcept
+        {
+            static const function_table table = resolve_function_table<rounds, counter_type>();
+            return table;
+        }
+    }
+
+    // Selects the fastest backend for running CPU.
+    namespace dispatch
+    {
+        using common::impl::prepare_context;
+
+        static inline const char* backend_name() noexcept
+        {
+            return impl::get_function_table<20>().name;
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return impl::get_function_table<rounds, counter_type>().process_stream(ctx, input, output, position, length);
+        }
+
+        template <int rounds = 20, class counter_type = counter_t>
+        static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            return impl::get_function_table<rounds, counter_type>().generate_keystream(ctx, output, position, length);
+        }
+
+        template <int rounds = 20>
+        static void hchacha_blocks(const key* keys, const hnonce* nonces, key* subkeys, size_t count)
+        {
+            return impl::get_function_table<rounds>().hchacha_blocks(keys, nonces, subkeys, count);
+        }
+
+        // processes independent streams (e.g. sectors with own nonces) together, packing blocks of different streams into SIMD lanes.
+        template <int rounds = 20, class counter_type = counter_t>
+        static void process_streams(const stream_job* jobs, size_t count)
+        {
+            return impl::get_function_table<rounds, counter_type>().process_streams(jobs, count);
+        }
+
+        // runtime-selected backend for engine<dispatch::backend, rounds, counter_type>.
+        struct backend
+        {
+            static const char* name() noexcept { return backend_name(); }
+            template <int rounds, class counter_type> static constexpr auto process_stream = dispatch::process_stream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto generate_keystream = dispatch::generate_keystream<rounds, counter_type>;
+            template <int rounds, class counter_type> static constexpr auto process_streams = dispatch::process_streams<rounds, counter_type>;
+            template <int rounds> static constexpr auto hchacha_blocks = dispatch::hchacha_blocks<rounds>;
+        };
+    }
+
+    using dispatch::prepare_context;
+    using dispatch::process_stream;
+    using dispatch::generate_keystream;
+    using dispatch::process_streams;
+
+    // Derives a subkey from key and 16-byte nonce. (HChaCha20)
+    static inline key hchacha20(const key* key, const hnonce* nonce)
+    {
+        chacha20::key subkey;
+        ref::impl::hchacha_blocks<20>(key, nonce, &subkey, 1);
+        return subkey;
+    }
+
+    // Derives count subkeys: subkeys[i] = HChaCha20(keys[i], nonces[i]). (SIMD batched)
+    static inline void hchacha20_batch(const key* keys, const hnonce* nonces, key* subkeys, size_t count)
+    {
+        return dispatch::hchacha_blocks<20>(keys, nonces, subkeys, count);
+    }
+
+    // Extended-nonce variant (XChaCha20): 24-byte nonce.
+    namespace xchacha20
+    {
+        using chacha20::context_t;
+
+        static inline context_t prepare_context(const key* key, const xnonce* nonce, counter_t initial_counter = 0)
+        {
+            chacha20::key subkey = hchacha20(key, reinterpret_cast<const hnonce*>(nonce->data()));
+            chacha20::nonce sub_nonce{};
+            std::memcpy(sub_nonce.data() + 4, nonce->data() + 16, 8);
+            context_t ctx = chacha20::prepare_context(&subkey, &sub_nonce, initial_counter);
+            arkintr::secure_be_zero(subkey);
+            return ctx;
+        }
+
+        using chacha20::process_stream;
+        using chacha20::generate_keystream;
+    }
+
+    // Original (DJB) layout: 64-bit block counter (words 12..13) and 8-byte nonce (words 14..15).
+    // position is not limited to 256 GiB.
+    namespace ctr64
+    {
+        using nonce = nonce64;
+        using counter_t = counter64_t;
+        using chacha20::context_t;
+
+        static inline context_t prepare_context(const key* key, const nonce* nonce, counter_t initial_counter = 0)
+        {
+            return common::impl::prepare_context(key, nonce, initial_counter);
+        }
+
+        static inline void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return dispatch::process_stream<20, counter_t>(ctx, input, output, position, length);
+        }
+
+        static inline void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            return dispatch::generate_keystream<20, counter_t>(ctx, output, position, length);
+        }
+    }
+
+    // Reduced-round variants. (for non-adversarial use: keystream, scrambling, hashing)
+    namespace chacha12
+    {
+        using chacha20::context_t;
+        using chacha20::prepare_context;
+
+        static inline void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return dispatch::process_stream<12>(ctx, input, output, position, length);
+        }
+
+        static inline void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            return dispatch::generate_keystream<12>(ctx, output, position, length);
+        }
+    }
+
+    namespace chacha8
+    {
+        using chacha20::context_t;
+        using chacha20::prepare_context;
+
+        static inline void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length)
+        {
+            return dispatch::process_stream<8>(ctx, input, output, position, length);
+        }
+
+        static inline void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length)
+        {
+            return dispatch::generate_keystream<8>(ctx, output, position, length);
+        }
+    }
 }
@@ -0,0 +1,184 @@
+/// @file
+/// @brief  chacha20_csprng.h - buffered ChaCha20 random number generator
+/// @author (c) 2023 ttsuki
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <limits>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#define ARKANA_CHACHA20_CSPRNG_FORK_DETECTION 1
+#endif
+
+#include "./chacha20.h"
+
+namespace chacha20
+{
+    // ChaCha20 CSPRNG with fast key erasure.
+    //  - refills a key stream buffer with the dispatched (widest) kernel,
+    //  - the first 32 bytes of every refill become the next key,
+    //  - every byte handed out is erased from the buffer.
+    // instances seeded from std::random_device reseed themselves in the child process after fork() (POSIX),
+    // so that parent and child do not hand out the same bytes. explicitly seeded instances are deterministic and do not.
+    // (a failure of std::random_device on that reseed terminates the process)
+    class csprng
+    {
+    public:
+        using result_type = uint64_t;
+
+        static constexpr size_t buffer_size = 8192;
+        static constexpr size_t bulk_threshold = buffer_size; // larger requests are generated directly into output
+
+        static constexpr result_type min() noexcept { return std::numeric_limits<result_type>::min(); }
+        static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+        // seeds from std::random_device.
+        csprng() { reseed(); }
+        explicit csprng(const key* seed) noexcept { reseed(seed); }
+        csprng(const csprng&) = delete;
+        csprng& operator=(const csprng&) = delete;
+        ~csprng()
+        {
+            arkintr::secure_be_zero(buffer_);
+            arkintr::secure_be_zero(key_);
+        }
+
+        void reseed()
+        {
+            std::random_device rd;
+            std::array<uint32_t, sizeof(key) / sizeof(uint32_t)> seed{};
+            for (auto& s : seed) s = rd();
+            reseed(reinterpret_cast<const key*>(seed.data()));
+            arkintr::secure_be_zero(seed);
+            self_seeded_ = true;
+            fork_generation_ = fork_generation().load(std::memory_order_relaxed);
+        }
+
+        void reseed(const key* seed) noexcept
+        {
+            key_ = *seed;
+            self_seeded_ = false;
+            refill();
+        }
+
+        result_type operator()() noexcept { return get<result_type>(); }
+
+        template <class T>
+        T get() noexcept
+        {
+            static_assert(std::is_trivially_copyable_v<T>);
+            T value;
+            read(&value, sizeof(T));
+            return value;
+        }
+
+        void fill(void* output, size_t length) noexcept
+        {
+            if (length < bulk_threshold)
+                return read(output, length);
+
+            // bulk: takes a one-time key from the buffer and writes its key stream directly.
+            key one_time_key;
+            read(&one_time_key, sizeof(one_time_key));
+            constexpr ctr64::nonce zero_nonce{};
+            auto ctx = ctr64::prepare_context(&one_time_key, &zero_nonce);
+            ctr64::generate_keystream(ctx, output, 0, length);
+            arkintr::secure_be_zero(ctx);
+            arkintr::secure_be_zero(one_time_key);
+        }
+
+        void fill(uint32_t* output, size_t count) noexcept { fill(static_cast<void*>(output), sizeof(uint32_t) * count); }
+        void fill(uint64_t* output, size_t count) noexcept { fill(static_cast<void*>(output), sizeof(uint64_t) * count); }
+
+        // uniform in [0, 1)
+        void fill(float* output, size_t count) noexcept
+        {
+            std::array<uint32_t, 1024> bits;
+            while (count)
+            {
+                const size_t n = std::min(count, bits.size());
+                fill(bits.data(), n);
+                for (size_t i = 0; i < n; i++)
+                    output[i] = static_cast<float>(bits[i] >> 8) * 0x1.0p-24f;
+                output += n;
+                count -= n;
+            }
+            arkintr::secure_be_zero(bits);
+        }
+
+        // per-thread instance seeded from std::random_device.
+        static csprng& thread_local_instance()
+        {
+            thread_local csprng instance{};
+            return instance;
+        }
+
+    private:
+        alignas(64) std::array<std::byte, buffer_size> buffer_;
+        size_t position_;
+        key key_;
+        bool self_seeded_{};
+        uint64_t fork_generation_{};
+
+        // incremented in the child process by fork().
+        static std::atomic<uint64_t>& fork_generation() noexcept
+        {
+            static std::atomic<uint64_t> generation{};
+#if defined(ARKANA_CHACHA20_CSPRNG_FORK_DETECTION)
+            static const int registered = pthread_atfork(nullptr, nullptr, [] { fork_generation().fetch_add(1, std::memory_order_relaxed); });
+            (void)registered;
+#endif
+            return generation;
+        }
+
+        void refill() noexcept
+        {
+            constexpr nonce zero_nonce{};
+            auto ctx = prepare_context(&key_, &zero_nonce);
+            generate_keystream(ctx, buffer_.data(), 0, buffer_.size());
+            arkintr::secure_be_zero(ctx);
+
+            std::memcpy(&key_, buffer_.data(), sizeof(key_));
+            std::memset(buffer_.data(), 0, sizeof(key_));
+            position_ = sizeof(key_);
+        }
+
+        void read(void* output, size_t length) noexcept
+        {
+            if (self_seeded_ && fork_generation_ != fork_generation().load(std::memory_order_relaxed))
+                reseed();
+
+            auto out = static_cast<std::byte*>(output);
+            while (length)
+            {
+                if (position_ == buffer_.size())
+                    refill();
+
+                const size_t n = std::min(length, buffer_.size() - position_);
+                std::memcpy(out, buffer_.data() + position_, n);
+                std::memset(buffer_.data() + position_, 0, n);
+                position_ += n;
+                out += n;
+                length -= n;
+            }
+        }
+    };
+
+    // UniformRandomBitGenerator on the thread-local csprng instance. (stateless, cheap to copy)
+    struct csprng_urbg
+    {
+        using result_type = csprng::result_type;
+        static constexpr result_type min() noexcept { return csprng::min(); }
+        static constexpr result_type max() noexcept { return csprng::max(); }
+        result_type operator()() const noexcept { return csprng::thread_local_instance()(); }
+    };
+}
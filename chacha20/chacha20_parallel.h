@@ -0,0 +1,69 @@
+/// @file
+/// @brief  chacha20_parallel.h - multi-threaded ChaCha20 stream processing
+/// @author (c) 2023 ttsuki
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+
+#include "../ark/thread_pool.h"
+#include "./chacha20.h"
+
+namespace chacha20::parallel
+{
+    using arkana::parallel::thread_pool;
+
+    // ChaCha20 is seekable: a stream is split at slice boundaries of stream position,
+    // and each slice is processed by the dispatched backend on a pool thread.
+    static constexpr size_t slice_size = 256 * 1024;         // fits in L2, multiple of every backend's block size
+    static constexpr size_t parallel_threshold = 1024 * 1024; // shorter streams are processed by the calling thread only
+    static_assert(slice_size % 1024 == 0);
+
+    // private impl
+    namespace impl
+    {
+        // process_slice(position_t position, size_t offset, size_t length): processes stream [position, position + length) at byte offset of buffers.
+        template <class process_slice_function>
+        static void for_each_slice(thread_pool& pool, position_t position, size_t length, process_slice_function&& process_slice)
+        {
+            if (length < parallel_threshold || pool.thread_count() == 0)
+                return process_slice(position, 0, length);
+
+            // slices begin at stream positions of multiple of slice_size, except the first.
+            const position_t first_slice = position / slice_size;
+            const position_t last_slice = (position + length - 1) / slice_size;
+            const position_t end = position + length;
+
+            pool.parallel_for(static_cast<size_t>(last_slice - first_slice + 1), [&](size_t i)
+            {
+                const position_t slice_begin = std::max<position_t>(position, (first_slice + i) * slice_size);
+                const position_t slice_end = std::min<position_t>(end, (first_slice + i + 1) * slice_size);
+                process_slice(slice_begin, static_cast<size_t>(slice_begin - position), static_cast<size_t>(slice_end - slice_begin));
+            });
+        }
+    }
+
+    // note: non_temporal_threshold() applies to each slice.
+    template <int rounds = 20, class counter_type = counter_t>
+    static void process_stream(const context_t& ctx, const void* input, void* output, position_t position, size_t length, thread_pool& pool = thread_pool::shared())
+    {
+        const auto in = static_cast<const std::byte*>(input);
+        const auto out = static_cast<std::byte*>(output);
+        impl::for_each_slice(pool, position, length, [&](position_t slice_position, size_t offset, size_t slice_length)
+        {
+            dispatch::process_stream<rounds, counter_type>(ctx, in + offset, out + offset, slice_position, slice_length);
+        });
+    }
+
+    template <int rounds = 20, class counter_type = counter_t>
+    static void generate_keystream(const context_t& ctx, void* output, position_t position, size_t length, thread_pool& pool = thread_pool::shared())
+    {
+        const auto out = static_cast<std::byte*>(output);
+        impl::for_each_slice(pool, position, length, [&](position_t slice_position, size_t offset, size_t slice_length)
+        {
+            dispatch::generate_keystream<rounds, counter_type>(ctx, out + offset, slice_position, slice_length);
+        });
+    }
+}
@@ -0,0 +1,118 @@
+/// @file
+/// @brief  chacha20_stream.h - stateful ChaCha20 stream with buffered key stream
+/// @author (c) 2023 ttsuki
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <array>
+#include <algorithm>
+
+#include "./chacha20.h"
+
+namespace chacha20
+{
+    // ChaCha20 stream that holds its context and position.
+    //  - short sequential requests are served from a key stream buffer,
+    //    so the key stream of a block is generated once even if it is consumed over several calls,
+    //  - long requests are processed directly by the dispatched kernel.
+    template <int rounds = 20, class counter_type = counter_t>
+    class basic_stream
+    {
+    public:
+        static constexpr size_t buffer_size = 1024; // multiple of every backend's block size
+        static constexpr size_t bulk_threshold = buffer_size;
+
+        explicit basic_stream(const context_t& ctx, position_t position = 0) noexcept
+            : ctx_(ctx), position_(position) { }
+
+        basic_stream(const basic_stream&) = delete;
+        basic_stream& operator=(const basic_stream&) = delete;
+
+        ~basic_stream()
+        {
+            arkintr::secure_be_zero(buffer_);
+            arkintr::secure_be_zero(ctx_);
+        }
+
+        position_t position() const noexcept { return position_; }
+
+        // the buffered key stream is kept if it covers the new position.
+        void seek(position_t position) noexcept { position_ = position; }
+
+        // output = input ^ key stream [position, position + length), then advances position.
+        void process(const void* input, void* output, size_t length) noexcept
+        {
+            return run<true>(static_cast<const std::byte*>(input), static_cast<std::byte*>(output), length);
+        }
+
+        // output = key stream [position, position + length), then advances position.
+        void generate_keystream(void* output, size_t length) noexcept
+        {
+            return run<false>(nullptr, static_cast<std::byte*>(output), length);
+        }
+
+    private:
+        context_t ctx_;
+        position_t position_;
+        position_t buffer_position_ = 0; // stream position of buffer_[0], multiple of buffer_size
+        bool buffer_valid_ = false;
+        alignas(64) std::array<std::byte, buffer_size> buffer_;
+
+        template <bool xor_input>
+        void run(const std::byte* input, std::byte* output, size_t length) noexcept
+        {
+            while (length)
+            {
+                size_t n;
+                if (buffer_valid_ && position_ - buffer_position_ < buffer_size)
+                {
+                    // serves from buffered key stream.
+                    const size_t offset = static_cast<size_t>(position_ - buffer_position_);
+                    n = std::min(length, buffer_size - offset);
+                    if constexpr (xor_input) xor_bytes(output, input, buffer_.data() + offset, n);
+                    else std::memcpy(output, buffer_.data() + offset, n);
+                }
+                else if (length >= bulk_threshold)
+                {
+                    // bulk: up to the last buffer boundary, directly.
+                    n = length - static_cast<size_t>((position_ + length) % buffer_size);
+                    if constexpr (xor_input) dispatch::process_stream<rounds, counter_type>(ctx_, input, output, position_, n);
+                    else dispatch::generate_keystream<rounds, counter_type>(ctx_, output, position_, n);
+                }
+                else
+                {
+                    // refills buffer with the key stream around current position.
+                    buffer_position_ = position_ - position_ % buffer_size;
+                    dispatch::generate_keystream<rounds, counter_type>(ctx_, buffer_.data(), buffer_position_, buffer_size);
+                    buffer_valid_ = true;
+                    continue;
+                }
+
+                position_ += n;
+                if constexpr (xor_input) input += n;
+                output += n;
+                length -= n;
+            }
+        }
+
+        static void xor_bytes(std::byte* output, const std::byte* input, const std::byte* key_stream, size_t length) noexcept
+        {
+            size_t i = 0;
+            for (; i + 8 <= length; i += 8)
+            {
+                uint64_t a, b;
+                std::memcpy(&a, input + i, 8);
+                std::memcpy(&b, key_stream + i, 8);
+                a ^= b;
+                std::memcpy(output + i, &a, 8);
+            }
+            for (; i < length; i++)
+                output[i] = input[i] ^ key_stream[i];
+        }
+    };
+
+    using stream = basic_stream<>;
+}
@@ -8,7 +8,15 @@
 
 #include <iostream>
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
 #include "./chacha20.h"
+#include "./chacha20_csprng.h"
+#include "./chacha20_parallel.h"
+#include "./chacha20_stream.h"
 
 using byte = uint8_t;
 
@@ -289,5 +297,522 @@ int main()
         }
     }
 
+    // reduced-round variants: all-zero key and nonce (draft-strombergson-chacha-test-vectors TC1, 256-bit key)
+    {
+        struct reduced_round_test
+        {
+            std::string name;
+            void (*process_stream)(const chacha20::context_t& ctx, const void* input, void* output, chacha20::position_t position, size_t length);
+            std::array<byte, 64> stream;
+        };
+
+        const reduced_round_test reduced_round_test_vectors[] = {
+            reduced_round_test{
+                "ChaCha8 TC1",
+                chacha20::chacha8::process_stream,
+                {
+                /* 000 */ 0x3e, 0x00, 0xef, 0x2f, 0x89, 0x5f, 0x40, 0xd6, 0x7f, 0x5b, 0xb8, 0xe8, 0x1f, 0x09, 0xa5, 0xa1,
+                /* 016 */ 0x2c, 0x84, 0x0e, 0xc3, 0xce, 0x9a, 0x7f, 0x3b, 0x18, 0x1b, 0xe1, 0x88, 0xef, 0x71, 0x1a, 0x1e,
+                /* 032 */ 0x98, 0x4c, 0xe1, 0x72, 0xb9, 0x21, 0x6f, 0x41, 0x9f, 0x44, 0x53, 0x67, 0x45, 0x6d, 0x56, 0x19,
+                /* 048 */ 0x31, 0x4a, 0x42, 0xa3, 0xda, 0x86, 0xb0, 0x01, 0x38, 0x7b, 0xfd, 0xb8, 0x0e, 0x0c, 0xfe, 0x42,
+                }
+            },
+            reduced_round_test{
+                "ChaCha12 TC1",
+                chacha20::chacha12::process_stream,
+                {
+                /* 000 */ 0x9b, 0xf4, 0x9a, 0x6a, 0x07, 0x55, 0xf9, 0x53, 0x81, 0x1f, 0xce, 0x12, 0x5f, 0x26, 0x83, 0xd5,
+                /* 016 */ 0x04, 0x29, 0xc3, 0xbb, 0x49, 0xe0, 0x74, 0x14, 0x7e, 0x00, 0x89, 0xa5, 0x2e, 0xae, 0x15, 0x5f,
+                /* 032 */ 0x05, 0x64, 0xf8, 0x79, 0xd2, 0x7a, 0xe3, 0xc0, 0x2c, 0xe8, 0x28, 0x34, 0xac, 0xfa, 0x8c, 0x79,
+                /* 048 */ 0x3a, 0x62, 0x9f, 0x2c, 0xa0, 0xde, 0x69, 0x19, 0x61, 0x0b, 0xe8, 0x2f, 0x41, 0x13, 0x26, 0xbe,
+                }
+            },
+        };
+
+        for (auto&& tv : reduced_round_test_vectors)
+        {
+            chacha20::key key{};
+            chacha20::nonce nonce{};
+            std::array<byte, 64> result{};
+            tv.process_stream(chacha20::prepare_context(&key, &nonce), result.data(), result.data(), 0, result.size());
+            if (result != tv.stream)
+            {
+                std::cerr << "TEST [" << tv.name << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+    }
+
+    // HChaCha20 (draft-irtf-cfrg-xchacha 2.2.1) and batched HChaCha20
+    {
+        chacha20::key key{};
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<byte>(i);
+        const chacha20::hnonce nonce = {
+            /* 000 */ 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00, 0x31, 0x41, 0x59, 0x27, // .......J....1AY'
+        };
+        const chacha20::key expected = {
+            /* 000 */ 0x82, 0x41, 0x3b, 0x42, 0x27, 0xb2, 0x7b, 0xfe, 0xd3, 0x0e, 0x42, 0x50, 0x8a, 0x87, 0x7d, 0x73, // .A;B'.{...BP..}s
+            /* 016 */ 0xa0, 0xf9, 0xe4, 0xd5, 0x8a, 0x74, 0xa8, 0x53, 0xc1, 0x2e, 0xc4, 0x13, 0x26, 0xd3, 0xec, 0xdc, // .....t.S....&...
+        };
+
+        if (chacha20::hchacha20(&key, &nonce) != expected)
+        {
+            std::cerr << "TEST [HChaCha20] FAILED" << "\n";
+            all_test_is_passed = false;
+        }
+
+        std::vector<chacha20::key> keys(19);
+        std::vector<chacha20::hnonce> nonces(keys.size());
+        std::vector<chacha20::key> subkeys(keys.size());
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            for (size_t j = 0; j < key.size(); j++) keys[i][j] = static_cast<byte>(i * 37 + j * 11);
+            for (size_t j = 0; j < nonce.size(); j++) nonces[i][j] = static_cast<byte>(i * 5 + j * 3);
+        }
+
+        chacha20::hchacha20_batch(keys.data(), nonces.data(), subkeys.data(), keys.size());
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (subkeys[i] != chacha20::hchacha20(&keys[i], &nonces[i]))
+            {
+                std::cerr << "TEST [HChaCha20 batch: " << i << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+    }
+
+    // 64-bit counter: the block after 2^32-1 carries into word 13.
+    {
+        chacha20::key key{};
+        chacha20::ctr64::nonce nonce64{};
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<byte>(i * 3 + 2);
+        for (size_t i = 0; i < nonce64.size(); i++) nonce64[i] = static_cast<byte>(i * 17 + 9);
+
+        // blocks [2^32-8, 2^32) and [2^32, 2^32+56) in 12-byte nonce layout: nonce = {counter_hi, nonce64}
+        const auto ietf_context = [&](uint32_t counter_hi, uint32_t counter_lo)
+        {
+            chacha20::nonce nonce{};
+            std::memcpy(nonce.data() + 0, &counter_hi, sizeof(counter_hi));
+            std::memcpy(nonce.data() + 4, nonce64.data(), nonce64.size());
+            return chacha20::prepare_context(&key, &nonce, counter_lo);
+        };
+
+        auto expected = std::vector<byte>(64 * 64);
+        auto result = std::vector<byte>(expected.size());
+        chacha20::ref::process_stream(ietf_context(0, 0xFFFFFFF8), expected.data(), expected.data(), 0, 64 * 8);
+        chacha20::ref::process_stream(ietf_context(1, 0x00000000), expected.data() + 64 * 8, expected.data() + 64 * 8, 0, 64 * 56);
+
+        const auto check = [&](const char* name, auto* process_stream, size_t position, size_t length)
+        {
+            std::fill(result.begin(), result.end(), byte{});
+            process_stream(chacha20::ctr64::prepare_context(&key, &nonce64, 0xFFFFFFF8), result.data() + position, result.data() + position, position, length);
+            if (std::memcmp(expected.data() + position, result.data() + position, length) != 0)
+            {
+                std::cerr << "TEST(ctr64 " << name << ") [position=" << position << ", length=" << length << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        };
+
+        for (size_t position : {size_t{0}, size_t{1}, size_t{64 * 7 + 3}, size_t{64 * 8}})
+        {
+            const size_t length = expected.size() - position;
+            check("ref", chacha20::ref::process_stream<20, chacha20::counter64_t>, position, length);
+#if defined(ARKANA_CHACHA20_VEC_AVAILABLE)
+            check("vec", chacha20::vec::process_stream<20, chacha20::counter64_t>, position, length);
+#endif
+#if defined(ARKANA_CPU_FEATURES_X86)
+            const auto& cpu = arkana::cpu_features::get();
+            if (cpu.ssse3) check("sse", chacha20::sse::process_stream<20, chacha20::counter64_t>, position, length);
+            if (cpu.avx2) check("avx2", chacha20::avx2::process_stream<20, chacha20::counter64_t>, position, length);
+            if (cpu.avx2) check("avx2 hybrid", chacha20::avx2::process_stream_hybrid<20, chacha20::counter64_t>, position, length);
+            if (cpu.avx512f && cpu.avx512vl) check("avx512", chacha20::avx512::process_stream<20, chacha20::counter64_t>, position, length);
+#endif
+            check(chacha20::dispatch::backend_name(), chacha20::ctr64::process_stream, position, length);
+            check("engine", chacha20::engine<chacha20::dispatch::backend, 20, chacha20::counter64_t>::process_stream, position, length);
+            check("tail", chacha20::ctr64::process_stream, position, 100);
+        }
+
+        // engine with 64-bit counter: its own prepare_context takes 8-byte nonce and 64-bit initial counter.
+        using engine64 = chacha20::engine<chacha20::dispatch::backend, 20, chacha20::counter64_t>;
+        static_assert(std::is_same_v<engine64::nonce_type, chacha20::ctr64::nonce>);
+        for (chacha20::counter64_t initial_counter : {chacha20::counter64_t{0xFFFFFFF8}, chacha20::counter64_t{0x100000000}})
+        {
+            const size_t offset = static_cast<size_t>(initial_counter - 0xFFFFFFF8) * 64;
+            std::fill(result.begin(), result.end(), byte{});
+            engine64::process_stream(engine64::prepare_context(&key, &nonce64, initial_counter), result.data(), result.data(), 0, expected.size() - offset);
+            if (std::memcmp(expected.data() + offset, result.data(), expected.size() - offset) != 0)
+            {
+                std::cerr << "TEST(ctr64 engine prepare_context) [initial_counter=" << initial_counter << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+    }
+
+    // csprng
+    {
+        chacha20::key seed{};
+        for (size_t i = 0; i < seed.size(); i++) seed[i] = static_cast<byte>(i * 5 + 1);
+
+        // buffered output is the key stream of the seed after the first 32 bytes (next key).
+        {
+            auto expected = std::vector<byte>(chacha20::csprng::buffer_size);
+            const chacha20::nonce zero_nonce{};
+            chacha20::ref::generate_keystream(chacha20::prepare_context(&seed, &zero_nonce), expected.data(), 0, expected.size());
+
+            chacha20::csprng rng(&seed);
+            auto result = std::vector<byte>(expected.size() - 32);
+            size_t filled = 0;
+            result[filled++] = rng.get<byte>();
+            for (size_t n : {size_t{1}, size_t{7}, size_t{8}, size_t{100}, size_t{1000}})
+                rng.fill(result.data() + filled, n), filled += n;
+            for (; filled + 8 <= result.size(); filled += 8)
+            {
+                auto v = rng();
+                std::memcpy(result.data() + filled, &v, 8);
+            }
+            rng.fill(result.data() + filled, result.size() - filled);
+
+            if (std::memcmp(expected.data() + 32, result.data(), result.size()) != 0)
+            {
+                std::cerr << "TEST [csprng stream] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+
+        // bulk fill is deterministic for the same seed and differs from the following output.
+        {
+            chacha20::csprng rng1(&seed), rng2(&seed);
+            auto a = std::vector<uint32_t>(100000);
+            auto b = std::vector<uint32_t>(a.size());
+            rng1.fill(a.data(), a.size());
+            rng2.fill(b.data(), b.size());
+            if (a != b || rng1() != rng2() || std::count(a.begin(), a.end(), 0u) > 2)
+            {
+                std::cerr << "TEST [csprng bulk] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+
+        // floats in [0, 1)
+        {
+            auto f = std::vector<float>(5000);
+            chacha20::csprng::thread_local_instance().fill(f.data(), f.size());
+            auto [min, max] = std::minmax_element(f.begin(), f.end());
+            if (*min < 0.0f || *max >= 1.0f || *max - *min < 0.9f)
+            {
+                std::cerr << "TEST [csprng float] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+
+        // UniformRandomBitGenerator
+        {
+            std::uniform_int_distribution<int> dist(1, 6);
+            chacha20::csprng_urbg urbg;
+            int histogram[7]{};
+            for (int i = 0; i < 6000; i++) histogram[dist(urbg)]++;
+            if (histogram[0] != 0 || *std::min_element(histogram + 1, histogram + 7) < 800)
+            {
+                std::cerr << "TEST [csprng urbg] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+
+#if defined(ARKANA_CHACHA20_CSPRNG_FORK_DETECTION)
+        // fork: the child does not repeat the parent's output.
+        {
+            auto& rng = chacha20::csprng::thread_local_instance();
+            rng.get<uint64_t>();
+
+            int fds[2]{};
+            std::array<uint64_t, 4> parent_output{}, child_output{};
+            if (pipe(fds) == 0)
+            {
+                if (const pid_t pid = fork(); pid == 0)
+                {
+                    rng.fill(child_output.data(), child_output.size());
+                    const bool written = write(fds[1], child_output.data(), sizeof(child_output)) == static_cast<ssize_t>(sizeof(child_output));
+                    _exit(written ? 0 : 1);
+                }
+                else if (pid > 0)
+                {
+                    rng.fill(parent_output.data(), parent_output.size());
+                    const bool read_all = read(fds[0], child_output.data(), sizeof(child_output)) == static_cast<ssize_t>(sizeof(child_output));
+                    waitpid(pid, nullptr, 0);
+                    if (!read_all || parent_output == child_output)
+                    {
+                        std::cerr << "TEST [csprng fork] FAILED" << "\n";
+                        all_test_is_passed = false;
+                    }
+                }
+                close(fds[0]);
+                close(fds[1]);
+            }
+        }
+#endif
+    }
+
+    // stream: sequential chunks of various lengths, and seeks, give the same output as one process_stream call.
+    {
+        chacha20::key key{};
+        chacha20::nonce nonce{};
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<byte>(i * 3 + 7);
+        const auto ctx = chacha20::prepare_context(&key, &nonce);
+
+        auto input = std::vector<byte>(10000);
+        for (size_t i = 0; i < input.size(); i++) input[i] = static_cast<byte>(i * 11);
+        auto expected = std::vector<byte>(input.size());
+        chacha20::ref::process_stream(ctx, input.data(), expected.data(), 0, input.size());
+
+        const auto check = [&](const char* name, const std::vector<byte>& result, size_t offset)
+        {
+            if (std::memcmp(expected.data() + offset, result.data() + offset, result.size() - offset) != 0)
+            {
+                std::cerr << "TEST [stream " << name << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        };
+
+        {
+            chacha20::stream stream(ctx);
+            auto result = std::vector<byte>(input.size());
+            size_t done = 0;
+            for (size_t n : {1, 63, 100, 100, 2000, 1, 1024, 3000, 7, 64})
+                stream.process(input.data() + done, result.data() + done, n), done += n;
+            stream.process(input.data() + done, result.data() + done, input.size() - done);
+            check("chunks", result, 0);
+        }
+
+        {
+            chacha20::stream stream(ctx, 5000);
+            auto result = std::vector<byte>(input.size());
+            stream.process(input.data() + 5000, result.data() + 5000, 100);
+            stream.seek(4000);
+            stream.process(input.data() + 4000, result.data() + 4000, 1000);
+            stream.seek(5100);
+            stream.process(input.data() + 5100, result.data() + 5100, input.size() - 5100);
+            check("seek", result, 4000);
+        }
+
+        {
+            chacha20::ref::generate_keystream(ctx, expected.data(), 0, input.size());
+            chacha20::stream stream(ctx, 1);
+            auto result = std::vector<byte>(input.size());
+            for (size_t done = 1; done < result.size(); done += 333)
+                stream.generate_keystream(result.data() + done, std::min<size_t>(333, result.size() - done));
+            check("keystream", result, 1);
+        }
+    }
+
+    // compares each backend with ref on long and unaligned streams.
+    {
+        chacha20::key key{};
+        chacha20::nonce nonce{};
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<byte>(i * 7 + 1);
+        for (size_t i = 0; i < nonce.size(); i++) nonce[i] = static_cast<byte>(i * 13 + 5);
+
+        auto plain_text = std::vector<byte>(8192 + 64);
+        for (size_t i = 0; i < plain_text.size(); i++) plain_text[i] = static_cast<byte>(i * 31 + 3);
+
+        const auto ctx = chacha20::prepare_context(&key, &nonce);
+        auto expected = std::vector<byte>(plain_text.size());
+        auto result = std::vector<byte>(plain_text.size());
+        const auto check = [&](const char* name, auto* process_stream, auto* ref_process_stream)
+        {
+            for (size_t position : {size_t{0}, size_t{1}, size_t{20}, size_t{63}, size_t{64}, size_t{130}, size_t{960}, size_t{1000}, size_t{1024}, size_t{4095}})
+            {
+                // short lengths: partial blocks spanning 1 to 5 64-byte blocks.
+                for (size_t length : {size_t{0}, size_t{1}, size_t{64}, size_t{100}, size_t{129}, size_t{255}, size_t{300}, size_t{1024}, size_t{3000}, size_t{8192}})
+                {
+                    ref_process_stream(ctx, plain_text.data(), expected.data(), position, length);
+                    process_stream(ctx, plain_text.data(), result.data(), position, length);
+                    if (std::memcmp(expected.data(), result.data(), length) != 0)
+                    {
+                        std::cerr << "TEST(" << name << ") [position=" << position << ", length=" << length << "] FAILED" << "\n";
+                        all_test_is_passed = false;
+                    }
+                }
+            }
+        };
+
+#if defined(ARKANA_CHACHA20_VEC_AVAILABLE)
+        check("vec", chacha20::vec::process_stream<20>, chacha20::ref::process_stream<20>);
+        check("vec chacha8", chacha20::vec::process_stream<8>, chacha20::ref::process_stream<8>);
+#endif
+#if defined(ARKANA_CPU_FEATURES_X86)
+        const auto& cpu = arkana::cpu_features::get();
+        if (cpu.ssse3) check("sse", chacha20::sse::process_stream<20>, chacha20::ref::process_stream<20>);
+        if (cpu.avx2) check("avx2", chacha20::avx2::process_stream<20>, chacha20::ref::process_stream<20>);
+        if (cpu.avx2) check("avx2 hybrid", chacha20::avx2::process_stream_hybrid<20>, chacha20::ref::process_stream<20>);
+        if (cpu.avx2) check("avx2 hybrid chacha8", chacha20::avx2::process_stream_hybrid<8>, chacha20::ref::process_stream<8>);
+        if (cpu.avx512f && cpu.avx512vl) check("avx512", chacha20::avx512::process_stream<20>, chacha20::ref::process_stream<20>);
+#endif
+        check(chacha20::dispatch::backend_name(), chacha20::process_stream<20>, chacha20::ref::process_stream<20>);
+        check("chacha12", chacha20::chacha12::process_stream, chacha20::ref::process_stream<12>);
+        check("chacha8", chacha20::chacha8::process_stream, chacha20::ref::process_stream<8>);
+        check("engine ref chacha12", chacha20::engine<chacha20::ref::backend, 12>::process_stream, chacha20::ref::process_stream<12>);
+        check("engine dispatch chacha8", chacha20::engine<chacha20::dispatch::backend, 8>::process_stream, chacha20::ref::process_stream<8>);
+#if defined(ARKANA_CPU_FEATURES_X86)
+        if (cpu.avx2) check("engine avx2 chacha12", chacha20::engine<chacha20::avx2::backend, 12>::process_stream, chacha20::ref::process_stream<12>);
+#endif
+
+        // key stream only: same as encrypting zeros.
+        const auto check_keystream = [&](const char* name, auto* generate_keystream)
+        {
+            const auto zeros = std::vector<byte>(plain_text.size());
+            for (size_t position : {size_t{0}, size_t{1}, size_t{63}, size_t{1000}, size_t{4095}})
+            {
+                for (size_t length : {size_t{0}, size_t{1}, size_t{255}, size_t{3000}, size_t{8192}})
+                {
+                    chacha20::ref::process_stream(ctx, zeros.data(), expected.data(), position, length);
+                    generate_keystream(ctx, result.data(), position, length);
+                    if (std::memcmp(expected.data(), result.data(), length) != 0)
+                    {
+                        std::cerr << "TEST(keystream " << name << ") [position=" << position << ", length=" << length << "] FAILED" << "\n";
+                        all_test_is_passed = false;
+                    }
+                }
+            }
+        };
+
+        check_keystream("ref", chacha20::ref::generate_keystream<20>);
+#if defined(ARKANA_CHACHA20_VEC_AVAILABLE)
+        check_keystream("vec", chacha20::vec::generate_keystream<20>);
+#endif
+#if defined(ARKANA_CPU_FEATURES_X86)
+        if (cpu.ssse3) check_keystream("sse", chacha20::sse::generate_keystream<20>);
+        if (cpu.avx2) check_keystream("avx2", chacha20::avx2::generate_keystream<20>);
+        if (cpu.avx2) check_keystream("avx2 hybrid", chacha20::avx2::generate_keystream_hybrid<20>);
+        if (cpu.avx512f && cpu.avx512vl) check_keystream("avx512", chacha20::avx512::generate_keystream<20>);
+#endif
+        check_keystream(chacha20::dispatch::backend_name(), chacha20::generate_keystream<20>);
+
+        // non-temporal stores: aligned output, and unaligned output (falls back to regular stores).
+        chacha20::set_non_temporal_threshold(0);
+        const auto check_non_temporal = [&](const char* name, auto* process_stream, auto* generate_keystream)
+        {
+            alignas(64) static std::array<byte, 8192 + 64> aligned;
+            for (size_t misalignment : {size_t{0}, size_t{1}, size_t{16}})
+            {
+                for (size_t position : {size_t{0}, size_t{1}, size_t{1000}})
+                {
+                    const size_t length = 5000;
+                    byte* out = aligned.data() + misalignment;
+                    chacha20::ref::process_stream(ctx, plain_text.data(), expected.data(), position, length);
+                    process_stream(ctx, plain_text.data(), out, position, length);
+                    bool ok = std::memcmp(expected.data(), out, length) == 0;
+
+                    std::memcpy(out, plain_text.data(), length);
+                    process_stream(ctx, out, out, position, length); // in-place
+                    ok &= std::memcmp(expected.data(), out, length) == 0;
+
+                    chacha20::ref::generate_keystream(ctx, expected.data(), position, length);
+                    generate_keystream(ctx, out, position, length);
+                    ok &= std::memcmp(expected.data(), out, length) == 0;
+
+                    if (!ok)
+                    {
+                        std::cerr << "TEST(non-temporal " << name << ") [misalignment=" << misalignment << ", position=" << position << "] FAILED" << "\n";
+                        all_test_is_passed = false;
+                    }
+                }
+            }
+        };
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+        if (cpu.ssse3) check_non_temporal("sse", chacha20::sse::process_stream<20>, chacha20::sse::generate_keystream<20>);
+        if (cpu.avx2) check_non_temporal("avx2", chacha20::avx2::process_stream<20>, chacha20::avx2::generate_keystream<20>);
+        if (cpu.avx512f && cpu.avx512vl) check_non_temporal("avx512", chacha20::avx512::process_stream<20>, chacha20::avx512::generate_keystream<20>);
+#endif
+        check_non_temporal(chacha20::dispatch::backend_name(), chacha20::process_stream<20>, chacha20::generate_keystream<20>);
+        chacha20::set_non_temporal_threshold(SIZE_MAX);
+    }
+
+    // parallel: same as single-threaded.
+    {
+        chacha20::key key{};
+        chacha20::nonce nonce{};
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<byte>(i * 3 + 7);
+        const auto ctx = chacha20::prepare_context(&key, &nonce);
+
+        chacha20::parallel::thread_pool pool{3};
+        auto plain_text = std::vector<byte>(3 * 1024 * 1024 + 100);
+        for (size_t i = 0; i < plain_text.size(); i++) plain_text[i] = static_cast<byte>(i * 31 + 3);
+        auto expected = std::vector<byte>(plain_text.size());
+        auto result = std::vector<byte>(plain_text.size());
+
+        for (size_t position : {size_t{0}, size_t{12345}})
+        {
+            for (size_t length : {size_t{1000}, plain_text.size()})
+            {
+                chacha20::process_stream(ctx, plain_text.data(), expected.data(), position, length);
+                chacha20::parallel::process_stream(ctx, plain_text.data(), result.data(), position, length, pool);
+                bool ok = std::memcmp(expected.data(), result.data(), length) == 0;
+
+                chacha20::generate_keystream(ctx, expected.data(), position, length);
+                chacha20::parallel::generate_keystream(ctx, result.data(), position, length, pool);
+                ok &= std::memcmp(expected.data(), result.data(), length) == 0;
+
+                if (!ok)
+                {
+                    std::cerr << "TEST(parallel) [position=" << position << ", length=" << length << "] FAILED" << "\n";
+                    all_test_is_passed = false;
+                }
+            }
+        }
+    }
+
+    // multi-buffer: each stream same as process_stream with its own context.
+    {
+        constexpr size_t stream_count = 37;
+        std::vector<chacha20::context_t> contexts;
+        std::vector<chacha20::stream_job> jobs;
+        std::vector<std::vector<byte>> inputs, outputs, expected;
+        for (size_t i = 0; i < stream_count; i++)
+        {
+            chacha20::key key{};
+            chacha20::nonce nonce{};
+            for (size_t j = 0; j < key.size(); j++) key[j] = static_cast<byte>(i * 11 + j);
+            for (size_t j = 0; j < nonce.size(); j++) nonce[j] = static_cast<byte>(i * 5 + j * 3);
+            contexts.push_back(chacha20::prepare_context(&key, &nonce));
+
+            const size_t lengths[] = {0, 1, 63, 64, 100, 4096, 5000};
+            const size_t length = lengths[i % std::size(lengths)];
+            inputs.emplace_back(length);
+            for (size_t j = 0; j < length; j++) inputs.back()[j] = static_cast<byte>(i + j * 7);
+            outputs.emplace_back(length);
+            expected.emplace_back(length);
+        }
+        for (size_t i = 0; i < stream_count; i++)
+            jobs.push_back(chacha20::stream_job{&contexts[i], i * 4096 + i % 3 * 17, inputs[i].data(), outputs[i].data(), inputs[i].size()});
+
+        const auto check = [&](const char* name, auto* process_streams, auto* ref_process_stream)
+        {
+            for (auto& o : outputs) std::fill(o.begin(), o.end(), byte{0});
+            process_streams(jobs.data(), jobs.size());
+            for (size_t i = 0; i < stream_count; i++)
+            {
+                ref_process_stream(contexts[i], inputs[i].data(), expected[i].data(), jobs[i].position, inputs[i].size());
+                if (expected[i] != outputs[i])
+                {
+                    std::cerr << "TEST(process_streams " << name << ") [stream=" << i << "] FAILED" << "\n";
+                    all_test_is_passed = false;
+                }
+            }
+        };
+
+        check("ref", chacha20::ref::process_streams<20>, chacha20::ref::process_stream<20>);
+#if defined(ARKANA_CPU_FEATURES_X86)
+        const auto& cpu = arkana::cpu_features::get();
+        if (cpu.ssse3) check("sse", chacha20::sse::process_streams<20>, chacha20::ref::process_stream<20>);
+        if (cpu.avx2) check("avx2", chacha20::avx2::process_streams<20>, chacha20::ref::process_stream<20>);
+        if (cpu.avx512f && cpu.avx512vl) check("avx512", chacha20::avx512::process_streams<20>, chacha20::ref::process_stream<20>);
+        if (cpu.avx2) check("avx2 ctr64", chacha20::avx2::process_streams<20, chacha20::counter64_t>, chacha20::ref::process_stream<20, chacha20::counter64_t>);
+        if (cpu.avx512f && cpu.avx512vl) check("avx512 ctr64", chacha20::avx512::process_streams<20, chacha20::counter64_t>, chacha20::ref::process_stream<20, chacha20::counter64_t>);
+#endif
+        check(chacha20::dispatch::backend_name(), chacha20::process_streams<20>, chacha20::ref::process_stream<20>);
+        check("chacha8", chacha20::process_streams<8>, chacha20::ref::process_stream<8>);
+    }
+
     return all_test_is_passed ? 0 : 1;
 }
@@ -7,10 +7,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <algorithm>
 #include <array>
+#include <tuple>
+#include <utility>
 
 #include "../ark/intrinsics.h"
 #include "../ark/message_digest_helper.h"
+#include "../ark/cpu_features.h"
+#include "../ark/xmm_targets.h"
 
 namespace poly1305
 {
@@ -19,6 +24,15 @@ namespace poly1305
     using key_s = std::array<byte, 16>;
     using mac = std::array<byte, 16>;
 
+    // one message of a calculate_poly1305_tags batch: calculate_poly1305(r, s, message, length)
+    struct tag_job
+    {
+        const key_r* r;
+        const key_s* s;
+        const void* message;
+        size_t length;
+    };
+
     // private impl
     namespace x86::impl
     {
@@ -113,6 +127,86 @@ namespace poly1305
             adc(adc(adc(adc(adc(0, h[0], s[0]), h[1], s[1]), h[2], s[2]), h[3], s[3]), h[4], 0u);
             return load_u<mac>(h.data());
         }
+
+        // radix 2^26 representation for interleaved kernels: h = sum(limb[i] << 26i)
+        using uint130_limbs_t = std::array<uint32_t, 5>;
+
+        // r and 5 times of it, in radix 2^26.
+        struct limb_key_t
+        {
+            uint130_limbs_t r;
+            uint130_limbs_t s;
+        };
+
+        static ARKANA_FORCEINLINE uint130_limbs_t to_limbs(impl_tag, const uint130_t& h) noexcept
+        {
+            constexpr uint32_t mask = (1u << 26) - 1;
+            return {h[0] & mask, (h[0] >> 26 | h[1] << 6) & mask, (h[1] >> 20 | h[2] << 12) & mask, (h[2] >> 14 | h[3] << 18) & mask, h[3] >> 8 | h[4] << 24};
+        }
+
+        // limbs may be wider than 26 bits. (result is partially reduced: h[4] < 8)
+        static ARKANA_FORCEINLINE uint130_t from_limbs(impl_tag, const uint130_limbs_t& l) noexcept
+        {
+            using namespace arkintr;
+            uint130_t h{};
+            uint64_t t = l[0] + (uint64_t{l[1]} << 26);
+            h[0] = static_cast<uint32_t>(t), t >>= 32, t += uint64_t{l[2]} << 20;
+            h[1] = static_cast<uint32_t>(t), t >>= 32, t += uint64_t{l[3]} << 14;
+            h[2] = static_cast<uint32_t>(t), t >>= 32, t += uint64_t{l[4]} << 8;
+            h[3] = static_cast<uint32_t>(t), t >>= 32;
+            h[4] = static_cast<uint32_t>(t);
+
+            // h += (1+4) * (h>>130)
+            const auto c = std::exchange(h[4], h[4] & 3);
+            adc(adc(adc(adc(adc(0, h[0], (c >> 2) + (c & ~3u)), h[1], 0u), h[2], 0u), h[3], 0u), h[4], 0u);
+            return h;
+        }
+
+        // 16-byte chunk with pad bit 2^128.
+        static ARKANA_FORCEINLINE uint130_limbs_t load_limbs(impl_tag, const uint128_t& in, uint32_t pad) noexcept
+        {
+            constexpr uint32_t mask = (1u << 26) - 1;
+            return {in[0] & mask, (in[0] >> 26 | in[1] << 6) & mask, (in[1] >> 20 | in[2] << 12) & mask, (in[2] >> 14 | in[3] << 18) & mask, in[3] >> 8 | pad << 24};
+        }
+
+        static ARKANA_FORCEINLINE uint130_limbs_t add_limbs(impl_tag, const uint130_limbs_t& a, const uint130_limbs_t& b) noexcept
+        {
+            return {a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3], a[4] + b[4]};
+        }
+
+        static ARKANA_FORCEINLINE limb_key_t make_limb_key(impl_tag, const uint130_limbs_t& r) noexcept
+        {
+            limb_key_t key{r, {}};
+            for (size_t i = 0; i < r.size(); i++)
+                key.s[i] = r[i] * 5;
+            return key;
+        }
+
+        // h * r mod 2^130-5, partially reduced.
+        static ARKANA_FORCEINLINE uint130_limbs_t multiply_limbs(impl_tag, const uint130_limbs_t& h, const limb_key_t& key) noexcept
+        {
+            using namespace arkintr;
+            const auto& r = key.r;
+            const auto& s = key.s;
+
+            std::array<uint64_t, 5> d{};
+            d[0] = muld(h[0], r[0]) + muld(h[1], s[4]) + muld(h[2], s[3]) + muld(h[3], s[2]) + muld(h[4], s[1]);
+            d[1] = muld(h[0], r[1]) + muld(h[1], r[0]) + muld(h[2], s[4]) + muld(h[3], s[3]) + muld(h[4], s[2]);
+            d[2] = muld(h[0], r[2]) + muld(h[1], r[1]) + muld(h[2], r[0]) + muld(h[3], s[4]) + muld(h[4], s[3]);
+            d[3] = muld(h[0], r[3]) + muld(h[1], r[2]) + muld(h[2], r[1]) + muld(h[3], r[0]) + muld(h[4], s[4]);
+            d[4] = muld(h[0], r[4]) + muld(h[1], r[3]) + muld(h[2], r[2]) + muld(h[3], r[1]) + muld(h[4], r[0]);
+
+            // carry: limbs become 26 bits (l[1] slightly more).
+            constexpr uint32_t mask = (1u << 26) - 1;
+            uint130_limbs_t l;
+            d[1] += d[0] >> 26, l[0] = static_cast<uint32_t>(d[0]) & mask;
+            d[2] += d[1] >> 26, l[1] = static_cast<uint32_t>(d[1]) & mask;
+            d[3] += d[2] >> 26, l[2] = static_cast<uint32_t>(d[2]) & mask;
+            d[4] += d[3] >> 26, l[3] = static_cast<uint32_t>(d[3]) & mask;
+            d[0] = l[0] + (d[4] >> 26) * 5, l[4] = static_cast<uint32_t>(d[4]) & mask;
+            l[1] += static_cast<uint32_t>(d[0] >> 26), l[0] = static_cast<uint32_t>(d[0]) & mask;
+            return l;
+        }
     }
 
     // private impl
@@ -162,29 +256,161 @@ namespace poly1305
             h[2] = e[1].l & 3;
 
             // h += (1+4) * (e>>130)
-            adc(adc(adc(0, h[0], shrd(e[1].l, e[1].h, 2)), h[1], e[1].h >> 2), h[2], 0ull);
-            adc(adc(adc(0, h[0], e[1].l & ~3ull), h[1], e[1].h), h[2], 0ull);
+            adc(adc(adc(0, h[0], shrd(e[1].l, e[1].h, 2)), h[1], e[1].h >> 2), h[2], uint64_t{0});
+            adc(adc(adc(0, h[0], e[1].l & ~uint64_t{3}), h[1], e[1].h), h[2], uint64_t{0});
         }
 
-        static ARKANA_FORCEINLINE mac finalize_and_get_mac(impl_tag, uint130_t& h, uint128_t s) noexcept
+        // h = h mod 2^130-5 (fully reduced)
+        static ARKANA_FORCEINLINE void reduce(impl_tag, uint130_t& h) noexcept
         {
             using namespace arkintr;
 
-            // final reduction
             while (h[2] >= 4)
             {
                 auto t = std::exchange(h[2], h[2] & 3);
-                adc(adc(adc(0, h[0], t >> 2), h[1], 0ull), h[2], 0ull);
-                adc(adc(adc(0, h[0], t & ~3ull), h[1], 0ull), h[2], 0ull);
+                adc(adc(adc(0, h[0], t >> 2), h[1], uint64_t{0}), h[2], uint64_t{0});
+                adc(adc(adc(0, h[0], t & ~uint64_t{3}), h[1], uint64_t{0}), h[2], uint64_t{0});
             }
 
             constexpr uint130_t prime1305 = {0xFFFFFFFFFFFFFFFBu, 0xFFFFFFFFFFFFFFFFu, 3u};
             if (std::tie(h[2], h[1], h[0]) >= std::tie(prime1305[2], prime1305[1], prime1305[0]))
                 sbb(sbb(sbb(0, h[0], prime1305[0]), h[1], prime1305[1]), h[2], prime1305[2]);
+        }
+
+        static ARKANA_FORCEINLINE mac finalize_and_get_mac(impl_tag tag, uint130_t& h, uint128_t s) noexcept
+        {
+            using namespace arkintr;
 
-            adc(adc(adc(0, h[0], s[0]), h[1], s[1]), h[2], 0ull);
+            // final reduction
+            reduce(tag, h);
+
+            adc(adc(adc(0, h[0], s[0]), h[1], s[1]), h[2], uint64_t{0});
             return load_u<mac>(h.data());
         }
+
+        // radix 2^26 representation for SIMD kernels: h = sum(limb[i] << 26i)
+        using uint130_radix26_t = std::array<uint64_t, 5>;
+
+        static ARKANA_FORCEINLINE uint130_radix26_t to_radix26(const uint130_t& h) noexcept
+        {
+            constexpr uint64_t mask = (1u << 26) - 1;
+            return {h[0] & mask, h[0] >> 26 & mask, (h[0] >> 52 | h[1] << 12) & mask, h[1] >> 14 & mask, h[1] >> 40 | h[2] << 24};
+        }
+
+        // limbs may be wider than 26 bits. (result is partially reduced: h[2] < 8)
+        static ARKANA_FORCEINLINE uint130_t from_radix26(const uint130_radix26_t& l) noexcept
+        {
+            using namespace arkintr;
+            uint130_t h{l[0], 0, 0};
+            adc(adc(adc(0, h[0], l[1] << 26), h[1], l[1] >> 38), h[2], uint64_t{0});
+            adc(adc(adc(0, h[0], l[2] << 52), h[1], l[2] >> 12), h[2], uint64_t{0});
+            adc(adc(0, h[1], l[3] << 14), h[2], l[3] >> 50);
+            adc(adc(0, h[1], l[4] << 40), h[2], l[4] >> 24);
+
+            // h += (1+4) * (h>>130)
+            const auto t = std::exchange(h[2], h[2] & 3);
+            adc(adc(adc(0, h[0], (t >> 2) + (t & ~uint64_t{3})), h[1], uint64_t{0}), h[2], uint64_t{0});
+            return h;
+        }
+
+        // r^1..r^4 in radix 2^26, for SIMD kernels. (prepared on first use)
+        struct key_powers_t
+        {
+            std::array<std::array<uint32_t, 5>, 4> r;
+            bool ready;
+        };
+
+        static inline void prepare_key_powers(impl_tag tag, key_powers_t& powers, const uint128_t& r) noexcept
+        {
+            uint130_t h = {r[0], r[1], 0};
+            for (size_t k = 0; k < powers.r.size(); k++)
+            {
+                if (k) process_chunk(tag, h, uint128_t{}, 0, r); // h = h * r
+                uint130_t t = h;
+                reduce(tag, t);
+                const auto l = to_radix26(t);
+                for (size_t i = 0; i < l.size(); i++)
+                    powers.r[k][i] = static_cast<uint32_t>(l[i]);
+            }
+            powers.ready = true;
+        }
+
+        // radix 2^44 representation for interleaved kernels: h = l[0] + l[1] << 44 + l[2] << 88
+        using uint130_limbs_t = std::array<uint64_t, 3>;
+
+        // r and 20 times of it (2^132 == 4 * 5), in radix 2^44.
+        struct limb_key_t
+        {
+            uint130_limbs_t r;
+            uint130_limbs_t s;
+        };
+
+        static ARKANA_FORCEINLINE uint130_limbs_t to_limbs(impl_tag, const uint130_t& h) noexcept
+        {
+            constexpr uint64_t mask = (uint64_t{1} << 44) - 1;
+            return {h[0] & mask, (h[0] >> 44 | h[1] << 20) & mask, h[1] >> 24 | h[2] << 40};
+        }
+
+        // limbs may be wider than 44 bits. (result is partially reduced: h[2] < 8)
+        static ARKANA_FORCEINLINE uint130_t from_limbs(impl_tag, const uint130_limbs_t& l) noexcept
+        {
+            using namespace arkintr;
+            uint130_t h{l[0], 0, 0};
+            adc(adc(adc(0, h[0], l[1] << 44), h[1], l[1] >> 20), h[2], uint64_t{0});
+            adc(adc(0, h[1], l[2] << 24), h[2], l[2] >> 40);
+
+            // h += (1+4) * (h>>130)
+            const auto t = std::exchange(h[2], h[2] & 3);
+            adc(adc(adc(0, h[0], (t >> 2) + (t & ~uint64_t{3})), h[1], uint64_t{0}), h[2], uint64_t{0});
+            return h;
+        }
+
+        // 16-byte chunk with pad bit 2^128.
+        static ARKANA_FORCEINLINE uint130_limbs_t load_limbs(impl_tag, const uint128_t& in, uint64_t pad) noexcept
+        {
+            constexpr uint64_t mask = (uint64_t{1} << 44) - 1;
+            return {in[0] & mask, (in[0] >> 44 | in[1] << 20) & mask, in[1] >> 24 | pad << 40};
+        }
+
+        static ARKANA_FORCEINLINE uint130_limbs_t add_limbs(impl_tag, const uint130_limbs_t& a, const uint130_limbs_t& b) noexcept
+        {
+            return {a[0] + b[0], a[1] + b[1], a[2] + b[2]};
+        }
+
+        static ARKANA_FORCEINLINE limb_key_t make_limb_key(impl_tag, const uint130_limbs_t& r) noexcept
+        {
+            return {r, {0, r[1] * 20, r[2] * 20}};
+        }
+
+        // h * r mod 2^130-5, partially reduced.
+        static ARKANA_FORCEINLINE uint130_limbs_t multiply_limbs(impl_tag, const uint130_limbs_t& h, const limb_key_t& key) noexcept
+        {
+            using namespace arkintr;
+            const auto& r = key.r;
+            const auto& s = key.s;
+
+            // products are below 2^96: sums of 3 never overflow.
+            const auto accumulate = [](uint64x2_t a, uint64x2_t b, uint64x2_t c, uint64_t& l, uint64_t& h)
+            {
+                l = a.l, h = a.h;
+                adc(adc(0, l, b.l), h, b.h);
+                adc(adc(0, l, c.l), h, c.h);
+            };
+            uint64_t d0l, d0h, d1l, d1h, d2l, d2h;
+            accumulate(muld(h[0], r[0]), muld(h[1], s[2]), muld(h[2], s[1]), d0l, d0h);
+            accumulate(muld(h[0], r[1]), muld(h[1], r[0]), muld(h[2], s[2]), d1l, d1h);
+            accumulate(muld(h[0], r[2]), muld(h[1], r[1]), muld(h[2], r[0]), d2l, d2h);
+
+            // carry: limbs become 44, 44, 42 bits (l[1] slightly more).
+            constexpr uint64_t mask44 = (uint64_t{1} << 44) - 1;
+            constexpr uint64_t mask42 = (uint64_t{1} << 42) - 1;
+            uint130_limbs_t l;
+            adc(adc(0, d1l, shrd(d0l, d0h, 44)), d1h, uint64_t{0}), l[0] = d0l & mask44;
+            adc(adc(0, d2l, shrd(d1l, d1h, 44)), d2h, uint64_t{0}), l[1] = d1l & mask44;
+            l[0] += shrd(d2l, d2h, 42) * 5, l[2] = d2l & mask42;
+            l[1] += l[0] >> 44, l[0] &= mask44;
+            return l;
+        }
     }
 
     // private impl
@@ -199,25 +425,112 @@ namespace poly1305
         }
 
         template <class poly1305_tag_context>
-        static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length)
+        static ARKANA_FORCEINLINE void process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
         {
             using namespace arkintr;
-            return arkana::message_digest_helper::process_bytes(
-                ctx,
-                [](poly1305_tag_context& ctx, const std::byte* message, size_t length)
-                {
-                    auto h = ctx.h;
-                    auto& r = ctx.r;
-                    for (size_t i = 0, n = length / 16; i < n; ++i)
-                    {
-                        using input_layout_type = typename poly1305_tag_context::input_layout_type;
-                        input_layout_type input = load_u<input_layout_type>(message);
-                        process_chunk(ctx.tag, h, input, 1, r);
-                        message += 16;
-                    }
-                    ctx.h = h;
-                },
-                ctx.input, message, length);
+            auto h = ctx.h;
+            auto& r = ctx.r;
+            for (size_t i = 0, n = length / 16; i < n; ++i)
+            {
+                using input_layout_type = typename poly1305_tag_context::input_layout_type;
+                input_layout_type input = load_u<input_layout_type>(message);
+                process_chunk(ctx.tag, h, input, 1, r);
+                message += 16;
+            }
+            ctx.h = h;
+        }
+
+        // messages shorter than this are processed by the serial kernel.
+        static constexpr size_t interleave_threshold = 128;
+
+        // r^1..r^n in limb representation.
+        template <size_t n, class poly1305_tag_context>
+        static inline auto calculate_limb_key_powers(const poly1305_tag_context& ctx) noexcept
+        {
+            using uint130_t = decltype(ctx.h);
+            std::array<decltype(make_limb_key(ctx.tag, to_limbs(ctx.tag, ctx.h))), n> r{};
+            uint130_t h{};
+            std::copy(ctx.r.begin(), ctx.r.end(), h.begin());
+            for (size_t k = 0; k < n; k++)
+            {
+                if (k) process_chunk(ctx.tag, h, decltype(ctx.r){}, 0, ctx.r); // h = h * r
+                r[k] = make_limb_key(ctx.tag, to_limbs(ctx.tag, h));
+            }
+            arkintr::secure_be_zero(h);
+            return r;
+        }
+
+        // r^1..r^4 in limb representation, cached in the context for the SSE2 kernel. (prepared on first use)
+        template <class limb_key_t>
+        struct limb_key_powers_t
+        {
+            std::array<limb_key_t, 4> r;
+            bool ready;
+        };
+
+        template <class poly1305_tag_context>
+        static inline void prepare_limb_key_powers(poly1305_tag_context& ctx) noexcept
+        {
+            ctx.limb_key_powers.r = calculate_limb_key_powers<4>(ctx);
+            ctx.limb_key_powers.ready = true;
+        }
+
+        // `ways` independent accumulators over (16 * ways)-byte strides, combined at the end:
+        // lane j accumulates blocks (ways * n + j) with r^ways, then is multiplied by r^(ways - j).
+        // this breaks the serial h = (h + m) * r dependency chain at the cost of more instructions per chunk;
+        // it pays off only on cores wide enough to overlap the lanes, so backends do not dispatch it by default.
+        template <class poly1305_tag_context, size_t... j>
+        static ARKANA_FORCEINLINE void process_blocks_interleaved(poly1305_tag_context& ctx, const std::byte* message, size_t length, std::index_sequence<j...>) noexcept
+        {
+            using namespace arkintr;
+            using input_layout_type = typename poly1305_tag_context::input_layout_type;
+            using uint130_limbs_t = decltype(to_limbs(ctx.tag, ctx.h));
+
+            constexpr size_t ways = sizeof...(j);
+            constexpr size_t stride = 16 * ways;
+            if (length < stride)
+                return process_blocks(ctx, message, length);
+
+            auto r = calculate_limb_key_powers<ways>(ctx);
+
+            // lane 0 takes over current h.
+            std::array<uint130_limbs_t, ways> h = {load_limbs(ctx.tag, load_u<input_layout_type>(message + 16 * j), 1)...};
+            h[0] = add_limbs(ctx.tag, h[0], to_limbs(ctx.tag, ctx.h));
+            message += stride;
+            length -= stride;
+
+            const auto& rw = r[ways - 1];
+            for (; length >= stride; message += stride, length -= stride)
+                ((h[j] = add_limbs(ctx.tag, multiply_limbs(ctx.tag, h[j], rw), load_limbs(ctx.tag, load_u<input_layout_type>(message + 16 * j), 1))), ...);
+
+            uint130_limbs_t sum{};
+            ((sum = add_limbs(ctx.tag, sum, multiply_limbs(ctx.tag, h[j], r[ways - 1 - j]))), ...);
+            ctx.h = from_limbs(ctx.tag, sum);
+            arkintr::secure_be_zero(r);
+
+            // tail
+            if (length)
+                process_blocks(ctx, message, length);
+        }
+
+        template <size_t ways, class poly1305_tag_context>
+        static ARKANA_FORCEINLINE void process_blocks_interleaved(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            static_assert(ways >= 1 && ways <= 4);
+            return process_blocks_interleaved(ctx, message, length, std::make_index_sequence<ways>{});
+        }
+
+        // process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length)
+        template <class poly1305_tag_context, class process_blocks_function>
+        static inline poly1305_tag_context& process_bytes(process_blocks_function&& process_blocks, poly1305_tag_context& ctx, const void* message, size_t length)
+        {
+            return arkana::message_digest_helper::process_bytes(ctx, process_blocks, ctx.input, message, length);
+        }
+
+        template <class poly1305_tag_context>
+        static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length)
+        {
+            return process_bytes(process_blocks<poly1305_tag_context>, ctx, message, length);
         }
 
         template <class poly1305_tag_context>
@@ -259,6 +572,20 @@ namespace poly1305
             process_bytes(ctx, message, length);
             return finalize_and_get_mac(ctx);
         }
+
+        // tag_jobs one by one.
+        // prepare(const key_r* r, const key_s* s) -> poly1305_tag_context
+        // process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length)
+        template <class prepare_function, class process_blocks_function>
+        static inline void calculate_tags(prepare_function&& prepare, process_blocks_function&& process_blocks, const tag_job* jobs, size_t count, mac* macs)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                auto ctx = prepare(jobs[i].r, jobs[i].s);
+                process_bytes(process_blocks, ctx, jobs[i].message, jobs[i].length);
+                macs[i] = finalize_and_get_mac(ctx);
+            }
+        }
     }
 
     namespace x86
@@ -271,12 +598,25 @@ namespace poly1305
             impl::uint128_t r{};
             impl::uint128_t s{};
             arkana::message_digest_helper::digest_input_state_t<16> input{};
+            common::impl::limb_key_powers_t<impl::limb_key_t> limb_key_powers{};
         };
+    }
 
-        static inline poly1305_tag_context prepare_poly1305_tag_context(const key_r* r, const key_s* s) { return common::impl::prepare_poly1305_tag_context<poly1305_tag_context>(r, s); }
-        static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length) { return common::impl::process_bytes<poly1305_tag_context>(ctx, message, length); }
-        static inline mac finalize_and_get_mac(poly1305_tag_context& ctx) { return common::impl::finalize_and_get_mac(ctx); }
-        static inline mac calculate_poly1305(const key_r* r, const key_s* s, const void* message, size_t length) { return common::impl::calculate_poly1305<poly1305_tag_context>(r, s, message, length); }
+    // private impl
+    namespace x86::impl
+    {
+        static void process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            return common::impl::process_blocks(ctx, message, length);
+        }
+
+        // 2-way interleaved kernel.
+        static inline void process_blocks_interleaved(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            if (length < common::impl::interleave_threshold)
+                return common::impl::process_blocks(ctx, message, length);
+            return common::impl::process_blocks_interleaved<2>(ctx, message, length);
+        }
     }
 
     namespace x64
@@ -289,12 +629,625 @@ namespace poly1305
             impl::uint128_t r{};
             impl::uint128_t s{};
             arkana::message_digest_helper::digest_input_state_t<16> input{};
+            impl::key_powers_t key_powers{};
+            uint64_t r1_5_4{}; // r[1] * 5/4, for deferred-carry kernels
         };
+    }
+
+    // private impl
+    namespace x64::impl
+    {
+        static void process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            return common::impl::process_blocks(ctx, message, length);
+        }
+
+        static inline poly1305_tag_context prepare_context(const key_r* r, const key_s* s)
+        {
+            auto ctx = common::impl::prepare_poly1305_tag_context<poly1305_tag_context>(r, s);
+            ctx.r1_5_4 = ctx.r[1] + (ctx.r[1] >> 2);
+            return ctx;
+        }
+
+        // 2-way interleaved kernel.
+        static inline void process_blocks_interleaved(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            if (length < common::impl::interleave_threshold)
+                return common::impl::process_blocks(ctx, message, length);
+            return common::impl::process_blocks_interleaved<2>(ctx, message, length);
+        }
+    }
+}
+
+#if defined(ARKANA_CPU_FEATURES_X86) && ((defined(_MSC_VER) && _MSC_VER >= 1920 && defined(_M_X64)) || defined(__x86_64__))
+#define ARKANA_POLY1305_X64_BMI2_AVAILABLE 1
+ARKANA_TARGET_REGION_BEGIN("bmi2,adx")
+namespace poly1305
+{
+    // private impl
+    namespace x64::impl
+    {
+        // h = (h + in) * r, partially reduced (h[2] < 8).
+        // r[1] is a multiple of 4, so h[1] * r[1] * 2^128 = h[1] * (r[1] / 4) * 2^130 == h[1] * r1_5_4 (mod 2^130-5).
+        static ARKANA_FORCEINLINE void process_chunk_bmi2(uint130_t& h, uint128_t in, uint64_t pad, const uint128_t& r, uint64_t r1_5_4) noexcept
+        {
+            using namespace arkintr;
+
+            // h += in
+            adc(adc(adc(0, h[0], in[0]), h[1], in[1]), h[2], pad);
+
+            // d = h * r, folded into 3 limbs
+            uint64x2_t d0 = muld(h[0], r[0]);
+            d0 += muld(h[1], r1_5_4);
+            uint64x2_t d1 = muld(h[0], r[1]);
+            d1 += muld(h[1], r[0]);
+            d1 += uint64x2_t{h[2] * r1_5_4};
+            d1 += uint64x2_t{d0.h};
+            uint64_t d2 = h[2] * r[0] + d1.h;
 
+            // h = d & (1<<130)-1, h += (1+4) * (d>>130)
+            h[0] = d0.l;
+            h[1] = d1.l;
+            h[2] = d2 & 3;
+            adc(adc(adc(0, h[0], (d2 >> 2) + (d2 & ~uint64_t{3})), h[1], uint64_t{0}), h[2], uint64_t{0});
+        }
+
+        // scalar kernel compiled with mulx available, carries deferred to finalization.
+        static void process_blocks_bmi2(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            using namespace arkintr;
+            auto h = ctx.h;
+            const auto r = ctx.r;
+            const auto r1_5_4 = ctx.r1_5_4;
+            for (size_t i = 0, n = length / 16; i < n; ++i)
+            {
+                process_chunk_bmi2(h, load_u<uint128_t>(message), 1, r, r1_5_4);
+                message += 16;
+            }
+            ctx.h = h;
+        }
+    }
+}
+ARKANA_TARGET_REGION_END()
+#endif
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+#define ARKANA_POLY1305_AVX2_AVAILABLE 1
+ARKANA_TARGET_REGION_BEGIN("avx2")
+namespace poly1305
+{
+    // private impl
+    namespace avx2::impl
+    {
+        namespace arkxmm = arkana::xmm_avx2;
+        using x64::poly1305_tag_context;
+
+        // messages shorter than this are processed by the scalar kernel.
+        static constexpr size_t threshold = 256;
+
+        // 4 lanes of h in radix 2^26: limbs[i] = {lane0, lane1, lane2, lane3}
+        using limbs_t = std::array<arkxmm::vu64x4, 5>;
+
+        // vpmuludq: low 32 bits of each 64-bit lane.
+        ARKXMM_API mul(arkxmm::vu64x4 a, arkxmm::vu64x4 b) noexcept -> arkxmm::vu64x4
+        {
+            return arkxmm::mul32x32to64(arkxmm::reinterpret<arkxmm::vu32x8>(a), arkxmm::reinterpret<arkxmm::vu32x8>(b));
+        }
+
+        // h * r mod 2^130-5, partially reduced. (r5 = 5 * r)
+        ARKXMM_API multiply(const limbs_t& h, const limbs_t& r, const limbs_t& r5) noexcept -> limbs_t
+        {
+            limbs_t d;
+            d[0] = mul(h[0], r[0]) + mul(h[1], r5[4]) + mul(h[2], r5[3]) + mul(h[3], r5[2]) + mul(h[4], r5[1]);
+            d[1] = mul(h[0], r[1]) + mul(h[1], r[0]) + mul(h[2], r5[4]) + mul(h[3], r5[3]) + mul(h[4], r5[2]);
+            d[2] = mul(h[0], r[2]) + mul(h[1], r[1]) + mul(h[2], r[0]) + mul(h[3], r5[4]) + mul(h[4], r5[3]);
+            d[3] = mul(h[0], r[3]) + mul(h[1], r[2]) + mul(h[2], r[1]) + mul(h[3], r[0]) + mul(h[4], r5[4]);
+            d[4] = mul(h[0], r[4]) + mul(h[1], r[3]) + mul(h[2], r[2]) + mul(h[3], r[1]) + mul(h[4], r[0]);
+
+            // carry: limbs become 26 bits (d[1] slightly more).
+            const auto mask = arkxmm::u64x4((1u << 26) - 1);
+            arkxmm::vu64x4 c;
+            c = d[0] >> 26, d[0] = d[0] & mask, d[1] = d[1] + c;
+            c = d[1] >> 26, d[1] = d[1] & mask, d[2] = d[2] + c;
+            c = d[2] >> 26, d[2] = d[2] & mask, d[3] = d[3] + c;
+            c = d[3] >> 26, d[3] = d[3] & mask, d[4] = d[4] + c;
+            c = d[4] >> 26, d[4] = d[4] & mask, d[0] = d[0] + c + (c << 2);
+            c = d[0] >> 26, d[0] = d[0] & mask, d[1] = d[1] + c;
+            return d;
+        }
+
+        // 4 blocks (64 bytes) with pad bit 2^128, into lanes {block 0, block 2, block 1, block 3}.
+        ARKXMM_API load_message(const std::byte* message) noexcept -> limbs_t
+        {
+            const auto a = arkxmm::load_u<arkxmm::vu64x4>(message + 0);
+            const auto b = arkxmm::load_u<arkxmm::vu64x4>(message + 32);
+            const auto lo = arkxmm::unpack64_lo(a, b);
+            const auto hi = arkxmm::unpack64_hi(a, b);
+            const auto mask = arkxmm::u64x4((1u << 26) - 1);
+            return {lo & mask, lo >> 26 & mask, (lo >> 52 | hi << 12) & mask, hi >> 14 & mask, hi >> 40 | arkxmm::u64x4(1u << 24)};
+        }
+
+        // lane j holds r^(k[j] + 1), and 5 times of it.
+        ARKXMM_API load_key_powers(const x64::impl::key_powers_t& powers, size_t k0, size_t k1, size_t k2, size_t k3, limbs_t& r, limbs_t& r5) noexcept
+        {
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                r[i] = arkxmm::u64x4(powers.r[k0][i], powers.r[k1][i], powers.r[k2][i], powers.r[k3][i]);
+                r5[i] = r[i] + (r[i] << 2);
+            }
+        }
+
+        // 4 independent accumulators over 64-byte strides, combined at the end:
+        // h = (h + m0) * r^4 + m1 * r^3 + m2 * r^2 + m3 * r, where lane j accumulates blocks 4n+j with r^4.
+        template <void (*process_blocks_scalar)(poly1305_tag_context& ctx, const std::byte* message, size_t length)>
+        static void process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            if (length < threshold)
+                return process_blocks_scalar(ctx, message, length);
+
+            if (!ctx.key_powers.ready)
+                x64::impl::prepare_key_powers(ctx.tag, ctx.key_powers, ctx.r);
+
+            limbs_t r4, r4x5;
+            load_key_powers(ctx.key_powers, 3, 3, 3, 3, r4, r4x5);
+
+            // lane 0 takes over current h.
+            const auto h0 = x64::impl::to_radix26(ctx.h);
+            limbs_t h = load_message(message);
+            for (size_t i = 0; i < h.size(); i++)
+                h[i] = h[i] + arkxmm::u64x4(h0[i], 0, 0, 0);
+            message += 64;
+            length -= 64;
+
+            for (; length >= 64; message += 64, length -= 64)
+            {
+                h = multiply(h, r4, r4x5);
+                const limbs_t m = load_message(message);
+                for (size_t i = 0; i < h.size(); i++)
+                    h[i] = h[i] + m[i];
+            }
+
+            // lanes {block 0, block 2, block 1, block 3} * {r^4, r^2, r^3, r^1}, then sums lanes.
+            limbs_t rn, rn5;
+            load_key_powers(ctx.key_powers, 3, 1, 2, 0, rn, rn5);
+            h = multiply(h, rn, rn5);
+
+            x64::impl::uint130_radix26_t sum{};
+            for (size_t i = 0; i < h.size(); i++)
+            {
+                std::array<uint64_t, 4> lanes;
+                arkxmm::store_u<arkxmm::vu64x4>(lanes.data(), h[i]);
+                sum[i] = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+            }
+            ctx.h = x64::impl::from_radix26(sum);
+
+            // tail
+            if (length)
+                process_blocks_scalar(ctx, message, length);
+        }
+
+        // messages of this length or longer in a batch are processed one by one by process_blocks.
+        static constexpr size_t batch_bulk_min_length = 2048;
+
+        // a message of calculate_tags in one lane.
+        struct tag_lane
+        {
+            const tag_job* job;
+            mac* output;
+            size_t done;
+            x64::impl::uint128_t s;
+        };
+
+        // one message per lane, each with own key: lane j runs h = (h + m) * r over its blocks.
+        // a lane is refilled with the next message when it finishes. (idle lanes run with r = 0)
+        template <void (*process_blocks_scalar)(poly1305_tag_context& ctx, const std::byte* message, size_t length)>
+        static void calculate_tags(const tag_job* jobs, size_t count, mac* macs) noexcept
+        {
+            constexpr size_t lane_count = 4;
+            const auto mask = arkxmm::u64x4((1u << 26) - 1);
+            const x64::impl::impl_tag tag{};
+
+            std::array<tag_lane, lane_count> lanes{};
+            limbs_t h, r, r5;
+            for (size_t i = 0; i < h.size(); i++)
+                h[i] = r[i] = r5[i] = arkxmm::u64x4(0);
+
+            bool refill = true;
+            for (size_t next = 0;;)
+            {
+                // finishes lanes at the end of their messages, and refills them.
+                if (refill)
+                {
+                    refill = false;
+                    alignas(32) std::array<std::array<uint64_t, lane_count>, 5> hl, rl;
+                    for (size_t i = 0; i < h.size(); i++)
+                    {
+                        arkxmm::store_u<arkxmm::vu64x4>(hl[i].data(), h[i]);
+                        arkxmm::store_u<arkxmm::vu64x4>(rl[i].data(), r[i]);
+                    }
+
+                    bool active = false;
+                    for (size_t j = 0; j < lane_count; j++)
+                    {
+                        auto& lane = lanes[j];
+                        if (lane.job && lane.done < lane.job->length)
+                        {
+                            active = true;
+                            continue;
+                        }
+
+                        if (lane.job)
+                        {
+                            x64::impl::uint130_radix26_t l{};
+                            for (size_t i = 0; i < l.size(); i++) l[i] = hl[i][j];
+                            auto t = x64::impl::from_radix26(l);
+                            *lane.output = x64::impl::finalize_and_get_mac(tag, t, lane.s);
+                            lane = {};
+                        }
+
+                        for (size_t i = 0; i < h.size(); i++)
+                            hl[i][j] = rl[i][j] = 0;
+
+                        while (next < count && !lane.job)
+                        {
+                            const tag_job& job = jobs[next];
+                            mac* output = macs + next++;
+                            if (job.length == 0 || job.length >= batch_bulk_min_length)
+                            {
+                                common::impl::calculate_tags(x64::impl::prepare_context, process_blocks<process_blocks_scalar>, &job, 1, output);
+                                continue;
+                            }
+
+                            x64::impl::uint128_t clamped_r;
+                            lane = {&job, output, 0, {}};
+                            x64::impl::initialize_state(tag, clamped_r, lane.s, job.r, job.s);
+                            const auto k = x64::impl::to_radix26({clamped_r[0], clamped_r[1], 0});
+                            for (size_t i = 0; i < k.size(); i++) rl[i][j] = k[i];
+                            arkintr::secure_be_zero(clamped_r);
+                            active = true;
+                        }
+                    }
+
+                    for (size_t i = 0; i < h.size(); i++)
+                    {
+                        h[i] = arkxmm::load_u<arkxmm::vu64x4>(hl[i].data());
+                        r[i] = arkxmm::load_u<arkxmm::vu64x4>(rl[i].data());
+                        r5[i] = r[i] + (r[i] << 2);
+                    }
+                    arkintr::secure_be_zero(hl);
+                    arkintr::secure_be_zero(rl);
+
+                    if (!active)
+                        break;
+                }
+
+                // runs of whole blocks in every lane. (idle lanes read a zero block)
+                size_t run = SIZE_MAX;
+                for (const auto& lane : lanes)
+                    if (lane.job) run = std::min(run, (lane.job->length - lane.done) / 16);
+
+                if (run)
+                {
+                    static constexpr std::array<std::byte, 16> zero{};
+                    std::array<const std::byte*, lane_count> p;
+                    std::array<size_t, lane_count> stride;
+                    alignas(32) std::array<uint64_t, lane_count> pad;
+                    for (size_t j = 0; j < lane_count; j++)
+                    {
+                        auto& lane = lanes[j];
+                        p[j] = lane.job ? static_cast<const std::byte*>(lane.job->message) + lane.done : zero.data();
+                        stride[j] = lane.job ? 16 : 0;
+                        pad[j] = lane.job ? 1u << 24 : 0;
+                        if (lane.job) lane.done += 16 * run;
+                        if (lane.job) refill |= lane.done == lane.job->length;
+                    }
+
+                    const auto pad_bit = arkxmm::load_u<arkxmm::vu64x4>(pad.data());
+                    for (size_t n = 0; n < run; n++)
+                    {
+                        // {lane0, lane2 | lane1, lane3} unpacks into lanes {0, 1, 2, 3}.
+                        const auto a = arkxmm::u64x4(arkxmm::load_u<arkxmm::vu64x2>(p[0]), arkxmm::load_u<arkxmm::vu64x2>(p[2]));
+                        const auto b = arkxmm::u64x4(arkxmm::load_u<arkxmm::vu64x2>(p[1]), arkxmm::load_u<arkxmm::vu64x2>(p[3]));
+                        const auto l = arkxmm::unpack64_lo(a, b);
+                        const auto u = arkxmm::unpack64_hi(a, b);
+                        const limbs_t m = {l & mask, l >> 26 & mask, (l >> 52 | u << 12) & mask, u >> 14 & mask, u >> 40 | pad_bit};
+                        for (size_t i = 0; i < h.size(); i++)
+                            h[i] = h[i] + m[i];
+                        h = multiply(h, r, r5);
+                        for (size_t j = 0; j < lane_count; j++)
+                            p[j] += stride[j];
+                    }
+                    continue;
+                }
+
+                // a block per lane: whole blocks with pad bit 2^128, the last partial block padded with 0x01.
+                alignas(32) std::array<uint64_t, lane_count> lo{}, hi{}, pad{};
+                for (size_t j = 0; j < lane_count; j++)
+                {
+                    auto& lane = lanes[j];
+                    if (!lane.job) continue;
+
+                    const auto message = static_cast<const std::byte*>(lane.job->message) + lane.done;
+                    const size_t length = lane.job->length - lane.done;
+                    if (length >= 16)
+                    {
+                        memcpy(&lo[j], message + 0, 8);
+                        memcpy(&hi[j], message + 8, 8);
+                        pad[j] = 1u << 24;
+                        lane.done += 16;
+                    }
+                    else
+                    {
+                        std::array<std::byte, 16> block{};
+                        memcpy(block.data(), message, length);
+                        block[length] = std::byte{0x01};
+                        memcpy(&lo[j], block.data() + 0, 8);
+                        memcpy(&hi[j], block.data() + 8, 8);
+                        lane.done += length;
+                    }
+                    refill |= lane.done == lane.job->length;
+                }
+
+                const auto l = arkxmm::load_u<arkxmm::vu64x4>(lo.data());
+                const auto u = arkxmm::load_u<arkxmm::vu64x4>(hi.data());
+                const limbs_t m = {l & mask, l >> 26 & mask, (l >> 52 | u << 12) & mask, u >> 14 & mask, u >> 40 | arkxmm::load_u<arkxmm::vu64x4>(pad.data())};
+                for (size_t i = 0; i < h.size(); i++)
+                    h[i] = h[i] + m[i];
+                h = multiply(h, r, r5);
+            }
+        }
+    }
+}
+ARKANA_TARGET_REGION_END()
+#endif
+
+#if defined(ARKANA_CPU_FEATURES_X86)
+#define ARKANA_POLY1305_SSE2_AVAILABLE 1
+ARKANA_TARGET_REGION_BEGIN("sse2")
+namespace poly1305
+{
+    // private impl
+    namespace sse2::impl
+    {
+        namespace arkxmm = arkana::xmm_sse2;
+        using x86::poly1305_tag_context;
+
+        // messages shorter than this are processed by the scalar kernel.
+        static constexpr size_t threshold = 128;
+
+        // 2 lanes of h in radix 2^26: limbs[i] = {lane0, lane1}
+        using limbs_t = std::array<arkxmm::vu64x2, 5>;
+
+        // pmuludq: low 32 bits of each 64-bit lane.
+        ARKXMM_API mul(arkxmm::vu64x2 a, arkxmm::vu64x2 b) noexcept -> arkxmm::vu64x2
+        {
+            return arkxmm::mul32x32to64(arkxmm::reinterpret<arkxmm::vu32x4>(a), arkxmm::reinterpret<arkxmm::vu32x4>(b));
+        }
+
+        // h * r mod 2^130-5, partially reduced. (s = 5 * r)
+        ARKXMM_API multiply(const limbs_t& h, const limbs_t& r, const limbs_t& s) noexcept -> limbs_t
+        {
+            limbs_t d;
+            d[0] = mul(h[0], r[0]) + mul(h[1], s[4]) + mul(h[2], s[3]) + mul(h[3], s[2]) + mul(h[4], s[1]);
+            d[1] = mul(h[0], r[1]) + mul(h[1], r[0]) + mul(h[2], s[4]) + mul(h[3], s[3]) + mul(h[4], s[2]);
+            d[2] = mul(h[0], r[2]) + mul(h[1], r[1]) + mul(h[2], r[0]) + mul(h[3], s[4]) + mul(h[4], s[3]);
+            d[3] = mul(h[0], r[3]) + mul(h[1], r[2]) + mul(h[2], r[1]) + mul(h[3], r[0]) + mul(h[4], s[4]);
+            d[4] = mul(h[0], r[4]) + mul(h[1], r[3]) + mul(h[2], r[2]) + mul(h[3], r[1]) + mul(h[4], r[0]);
+
+            // carry: limbs become 26 bits (d[1] slightly more).
+            const auto mask = arkxmm::u64x2((1u << 26) - 1);
+            arkxmm::vu64x2 c;
+            c = d[0] >> 26, d[0] = d[0] & mask, d[1] = d[1] + c;
+            c = d[1] >> 26, d[1] = d[1] & mask, d[2] = d[2] + c;
+            c = d[2] >> 26, d[2] = d[2] & mask, d[3] = d[3] + c;
+            c = d[3] >> 26, d[3] = d[3] & mask, d[4] = d[4] + c;
+            c = d[4] >> 26, d[4] = d[4] & mask, d[0] = d[0] + c + (c << 2);
+            c = d[0] >> 26, d[0] = d[0] & mask, d[1] = d[1] + c;
+            return d;
+        }
+
+        // 2 blocks (32 bytes) with pad bit 2^128, into lanes {block 0, block 1}.
+        ARKXMM_API load_message(const std::byte* message) noexcept -> limbs_t
+        {
+            // movdqu: load_u is lddqu (SSE3).
+            const auto a = arkxmm::vu64x2{_mm_loadu_si128(reinterpret_cast<const __m128i*>(message + 0))};
+            const auto b = arkxmm::vu64x2{_mm_loadu_si128(reinterpret_cast<const __m128i*>(message + 16))};
+            const auto lo = arkxmm::unpack64_lo(a, b);
+            const auto hi = arkxmm::unpack64_hi(a, b);
+            const auto mask = arkxmm::u64x2((1u << 26) - 1);
+            return {lo & mask, lo >> 26 & mask, (lo >> 52 | hi << 12) & mask, hi >> 14 & mask, hi >> 40 | arkxmm::u64x2(1u << 24)};
+        }
+
+        // lane j holds r^(k[j] + 1), and 5 times of it.
+        ARKXMM_API load_key_powers(const common::impl::limb_key_powers_t<x86::impl::limb_key_t>& powers, size_t k0, size_t k1, limbs_t& r, limbs_t& s) noexcept
+        {
+            for (size_t i = 0; i < r.size(); i++)
+            {
+                r[i] = arkxmm::u64x2(powers.r[k0].r[i], powers.r[k1].r[i]);
+                s[i] = arkxmm::u64x2(powers.r[k0].s[i], powers.r[k1].s[i]);
+            }
+        }
+
+        // 2 independent accumulators over 32-byte strides, combined at the end:
+        // lane j accumulates blocks 2n+j with r^2, then lanes are multiplied by {r^2, r}.
+        static void process_blocks(poly1305_tag_context& ctx, const std::byte* message, size_t length) noexcept
+        {
+            if (length < threshold)
+                return x86::impl::process_blocks(ctx, message, length);
+
+            if (!ctx.limb_key_powers.ready)
+                common::impl::prepare_limb_key_powers(ctx);
+
+            limbs_t r2, r2x5;
+            load_key_powers(ctx.limb_key_powers, 1, 1, r2, r2x5);
+
+            // lane 0 takes over current h.
+            const auto h0 = x86::impl::to_limbs(ctx.tag, ctx.h);
+            limbs_t h = load_message(message);
+            for (size_t i = 0; i < h.size(); i++)
+                h[i] = h[i] + arkxmm::u64x2(h0[i], 0);
+            message += 32;
+            length -= 32;
+
+            for (; length >= 32; message += 32, length -= 32)
+            {
+                h = multiply(h, r2, r2x5);
+                const limbs_t m = load_message(message);
+                for (size_t i = 0; i < h.size(); i++)
+                    h[i] = h[i] + m[i];
+            }
+
+            limbs_t rn, rnx5;
+            load_key_powers(ctx.limb_key_powers, 1, 0, rn, rnx5);
+            h = multiply(h, rn, rnx5);
+
+            x86::impl::uint130_limbs_t sum{};
+            for (size_t i = 0; i < h.size(); i++)
+            {
+                std::array<uint64_t, 2> lanes;
+                arkxmm::store_u<arkxmm::vu64x2>(lanes.data(), h[i]);
+                sum[i] = static_cast<uint32_t>(lanes[0] + lanes[1]);
+            }
+            ctx.h = x86::impl::from_limbs(ctx.tag, sum);
+
+            // tail
+            if (length)
+                x86::impl::process_blocks(ctx, message, length);
+        }
+    }
+}
+ARKANA_TARGET_REGION_END()
+#endif
+
+namespace poly1305
+{
+    // private impl
+    namespace x86::impl
+    {
+        using process_blocks_function = void(poly1305_tag_context& ctx, const std::byte* message, size_t length);
+        using calculate_tags_function = void(const tag_job* jobs, size_t count, mac* macs);
+
+        struct function_table
+        {
+            const char* name;
+            process_blocks_function* process_blocks;
+            calculate_tags_function* calculate_tags;
+        };
+
+        template <process_blocks_function* process_blocks>
+        static void calculate_tags(const tag_job* jobs, size_t count, mac* macs)
+        {
+            return common::impl::calculate_tags(common::impl::prepare_poly1305_tag_context<poly1305_tag_context>, process_blocks, jobs, count, macs);
+        }
+
+        static function_table resolve_function_table() noexcept
+        {
+#if defined(ARKANA_POLY1305_SSE2_AVAILABLE)
+            const auto& cpu = arkana::cpu_features::get();
+            if (cpu.sse2) return {"x86-sse2", sse2::impl::process_blocks, calculate_tags<sse2::impl::process_blocks>};
+#endif
+            return {"x86", process_blocks, calculate_tags<process_blocks>};
+        }
+
+        static const function_table& get_function_table() noexcept
+        {
+            static const function_table table = resolve_function_table();
+            return table;
+        }
+    }
+
+    // x86: dispatches block function at runtime.
+    namespace x86
+    {
+        static inline const char* backend_name() noexcept { return impl::get_function_table().name; }
         static inline poly1305_tag_context prepare_poly1305_tag_context(const key_r* r, const key_s* s) { return common::impl::prepare_poly1305_tag_context<poly1305_tag_context>(r, s); }
-        static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length) { return common::impl::process_bytes<poly1305_tag_context>(ctx, message, length); }
+        static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length) { return common::impl::process_bytes(impl::get_function_table().process_blocks, ctx, message, length); }
         static inline mac finalize_and_get_mac(poly1305_tag_context& ctx) { return common::impl::finalize_and_get_mac(ctx); }
-        static inline mac calculate_poly1305(const key_r* r, const key_s* s, const void* message, size_t length) { return common::impl::calculate_poly1305<poly1305_tag_context>(r, s, message, length); }
+        static inline mac calculate_poly1305(const key_r* r, const key_s* s, const void* message, size_t length)
+        {
+            auto ctx = prepare_poly1305_tag_context(r, s);
+            process_bytes(ctx, message, length);
+            return finalize_and_get_mac(ctx);
+        }
+
+        // calculates tags of independent messages (e.g. packets with own keys) together, packing messages into SIMD lanes.
+        static inline void calculate_poly1305_tags(const tag_job* jobs, size_t count, mac* macs) { return impl::get_function_table().calculate_tags(jobs, count, macs); }
+    }
+
+    // private impl
+    namespace x64::impl
+    {
+        using process_blocks_function = void(poly1305_tag_context& ctx, const std::byte* message, size_t length);
+        using calculate_tags_function = void(const tag_job* jobs, size_t count, mac* macs);
+
+        struct function_table
+        {
+            const char* name;
+            process_blocks_function* process_blocks;
+            calculate_tags_function* calculate_tags;
+        };
+
+        template <process_blocks_function* process_blocks>
+        static void calculate_tags(const tag_job* jobs, size_t count, mac* macs)
+        {
+            return common::impl::calculate_tags(prepare_context, process_blocks, jobs, count, macs);
+        }
+
+        static function_table resolve_function_table() noexcept
+        {
+#if defined(ARKANA_CPU_FEATURES_X86)
+            const auto& cpu = arkana::cpu_features::get();
+#endif
+#if defined(ARKANA_POLY1305_AVX2_AVAILABLE) && defined(ARKANA_POLY1305_X64_BMI2_AVAILABLE)
+            if (cpu.avx2 && cpu.bmi2 && cpu.adx) return {"x64-avx2-bmi2", avx2::impl::process_blocks<process_blocks_bmi2>, avx2::impl::calculate_tags<process_blocks_bmi2>};
+#endif
+#if defined(ARKANA_POLY1305_AVX2_AVAILABLE)
+            if (cpu.avx2) return {"x64-avx2", avx2::impl::process_blocks<process_blocks>, avx2::impl::calculate_tags<process_blocks>};
+#endif
+#if defined(ARKANA_POLY1305_X64_BMI2_AVAILABLE)
+            if (cpu.bmi2 && cpu.adx) return {"x64-bmi2", process_blocks_bmi2, calculate_tags<process_blocks_bmi2>};
+#endif
+            return {"x64", process_blocks, calculate_tags<process_blocks>};
+        }
+
+        static const function_table& get_function_table() noexcept
+        {
+            static const function_table table = resolve_function_table();
+            return table;
+        }
+    }
+
+    // x64: dispatches block function at runtime.
+    namespace x64
+    {
+        static inline const char* backend_name() noexcept { return impl::get_function_table().name; }
+        static inline poly1305_tag_context prepare_poly1305_tag_context(const key_r* r, const key_s* s) { return impl::prepare_context(r, s); }
+        static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length) { return common::impl::process_bytes(impl::get_function_table().process_blocks, ctx, message, length); }
+        static inline mac finalize_and_get_mac(poly1305_tag_context& ctx) { return common::impl::finalize_and_get_mac(ctx); }
+        static inline mac calculate_poly1305(const key_r* r, const key_s* s, const void* message, size_t length)
+        {
+            auto ctx = prepare_poly1305_tag_context(r, s);
+            process_bytes(ctx, message, length);
+            return finalize_and_get_mac(ctx);
+        }
+
+        // calculates tags of independent messages (e.g. packets with own keys) together, packing messages into SIMD lanes.
+        static inline void calculate_poly1305_tags(const tag_job* jobs, size_t count, mac* macs) { return impl::get_function_table().calculate_tags(jobs, count, macs); }
+    }
+
+    // compares macs[i] with expected[i] in constant time: returns whether all of them are equal, and results[i] for each. (if results is not null)
+    static inline bool verify_poly1305_tags(const mac* macs, const mac* expected, size_t count, bool* results = nullptr) noexcept
+    {
+        uint32_t all = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t diff = 0;
+            for (size_t k = 0; k < macs[i].size(); k++)
+                diff |= macs[i][k] ^ expected[i][k];
+            all |= diff;
+            if (results) results[i] = diff == 0;
+        }
+        return all == 0;
     }
 
     // Expose default implementation as api
@@ -305,11 +1258,13 @@ namespace poly1305
     using x64::process_bytes;
     using x64::finalize_and_get_mac;
     using x64::calculate_poly1305;
+    using x64::calculate_poly1305_tags;
 #else
     using x86::poly1305_tag_context;
     using x86::prepare_poly1305_tag_context;
     using x86::process_bytes;
     using x86::finalize_and_get_mac;
     using x86::calculate_poly1305;
+    using x86::calculate_poly1305_tags;
 #endif
 }
@@ -0,0 +1,134 @@
+/// @file
+/// @brief  poly1305_parallel.h - multi-threaded Poly1305 for long messages
+/// @author (c) 2023 ttsuki
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+
+#include "../ark/thread_pool.h"
+#include "./poly1305.h"
+
+namespace poly1305::parallel
+{
+    using arkana::parallel::thread_pool;
+
+    // Poly1305 is a polynomial in r: a message is split into slices, each slice is hashed from h = 0
+    // on a pool thread, and the slice hashes are combined by Horner's rule with r^(slice blocks):
+    //   h' = (...((h * r^n0 + h0) * r^n1 + h1) ...) * r^nk + hk
+    static constexpr size_t slice_size = 256 * 1024;         // fits in L2, multiple of the block size
+    static constexpr size_t parallel_threshold = 1024 * 1024; // shorter messages are processed by the calling thread only
+    static_assert(slice_size % 16 == 0);
+
+    // private impl
+    namespace impl
+    {
+        template <class poly1305_tag_context>
+        using uint130_t = decltype(poly1305_tag_context::h);
+
+        template <class poly1305_tag_context>
+        static inline auto power_of_key(const poly1305_tag_context& ctx, uint64_t exponent) noexcept
+        {
+            uint130_t<poly1305_tag_context> r{};
+            std::copy(ctx.r.begin(), ctx.r.end(), r.begin());
+
+            // square-and-multiply in limb representation. (exponent >= 1)
+            auto base = to_limbs(ctx.tag, r);
+            auto result = base;
+            bool first = true;
+            for (; exponent; exponent >>= 1)
+            {
+                if (exponent & 1)
+                    result = std::exchange(first, false) ? base : multiply_limbs(ctx.tag, result, make_limb_key(ctx.tag, base));
+                if (exponent > 1)
+                    base = multiply_limbs(ctx.tag, base, make_limb_key(ctx.tag, base));
+            }
+            const auto key = make_limb_key(ctx.tag, result);
+            arkintr::secure_be_zero(r);
+            arkintr::secure_be_zero(base);
+            arkintr::secure_be_zero(result);
+            return key;
+        }
+
+        // hash of whole blocks [message, message + length) from h = 0, by the dispatched kernel. (length % 16 == 0)
+        template <class poly1305_tag_context>
+        static inline auto hash_slice(const poly1305_tag_context& ctx, const std::byte* message, size_t length)
+        {
+            poly1305_tag_context slice = ctx;
+            slice.h = {};
+            slice.input = {};
+            process_bytes(slice, message, length); // the backend's, found by ADL
+            const auto h = slice.h;
+            arkintr::secure_be_zero(slice);
+            return h;
+        }
+
+        // ctx.h = Horner combination of slice hashes over `length` bytes split at slice_size. (length % 16 == 0)
+        template <class poly1305_tag_context>
+        static inline void absorb_slices(poly1305_tag_context& ctx, const uint130_t<poly1305_tag_context>* hashes, size_t count, size_t length) noexcept
+        {
+            const size_t last_length = length - (count - 1) * slice_size;
+            auto r_slice = power_of_key(ctx, slice_size / 16);
+            auto r_last = power_of_key(ctx, last_length / 16);
+
+            auto h = to_limbs(ctx.tag, ctx.h);
+            for (size_t i = 0; i < count; i++)
+                h = add_limbs(ctx.tag, multiply_limbs(ctx.tag, h, i + 1 < count ? r_slice : r_last), to_limbs(ctx.tag, hashes[i]));
+            ctx.h = from_limbs(ctx.tag, h);
+            ctx.input.total_input_byte_count += length;
+
+            arkintr::secure_be_zero(r_slice);
+            arkintr::secure_be_zero(r_last);
+            arkintr::secure_be_zero(h);
+        }
+
+        // process_slice(size_t offset, size_t length): processes [offset, offset + length) of the message and returns its slice hash.
+        template <class poly1305_tag_context, class process_slice_function>
+        static inline void for_each_slice(thread_pool& pool, poly1305_tag_context& ctx, size_t length, process_slice_function&& process_slice)
+        {
+            const size_t count = (length + slice_size - 1) / slice_size;
+            std::vector<uint130_t<poly1305_tag_context>> hashes(count);
+            pool.parallel_for(count, [&](size_t i)
+            {
+                const size_t offset = i * slice_size;
+                hashes[i] = process_slice(offset, std::min(slice_size, length - offset));
+            });
+            absorb_slices(ctx, hashes.data(), count, length);
+            for (auto& h : hashes)
+                arkintr::secure_be_zero(h);
+        }
+    }
+
+    static inline poly1305_tag_context& process_bytes(poly1305_tag_context& ctx, const void* message, size_t length, thread_pool& pool = thread_pool::shared())
+    {
+        if (length < parallel_threshold || pool.thread_count() == 0)
+            return poly1305::process_bytes(ctx, message, length);
+
+        // completes a buffered partial block first, so slices begin at block boundaries.
+        auto src = static_cast<const std::byte*>(message);
+        const size_t head = std::min(length, (16 - ctx.input.total_input_byte_count % 16) % 16);
+        poly1305::process_bytes(ctx, src, head);
+        src += head;
+        length -= head;
+
+        const size_t body = length / 16 * 16;
+        impl::for_each_slice(pool, ctx, body, [&](size_t offset, size_t slice_length)
+        {
+            return impl::hash_slice(ctx, src + offset, slice_length);
+        });
+        src += body;
+        length -= body;
+
+        return poly1305::process_bytes(ctx, src, length);
+    }
+
+    static inline mac calculate_poly1305(const key_r* r, const key_s* s, const void* message, size_t length, thread_pool& pool = thread_pool::shared())
+    {
+        auto ctx = prepare_poly1305_tag_context(r, s);
+        process_bytes(ctx, message, length, pool);
+        return finalize_and_get_mac(ctx);
+    }
+}
@@ -3,12 +3,14 @@
 #include <cstddef>
 #include <cstdint>
 #include <string>
+#include <array>
 #include <vector>
 #include <algorithm>
 
 #include <iostream>
 
 #include "./poly1305.h"
+#include "./poly1305_parallel.h"
 
 using byte = uint8_t;
 
@@ -258,10 +260,143 @@ int main()
                 result.begin(),
                 result.end()))
         {
-            std::cerr << "TEST(x86) [" << tv.name << "] FAILED" << "\n";
+            std::cerr << "TEST(" << poly1305::x86::backend_name() << ") [" << tv.name << "] FAILED" << "\n";
             all_test_is_passed = false;
         }
     }
 
+    // long messages: dispatched SIMD kernels and interleaved kernels vs serial x86 kernel, one-shot and chunked.
+    {
+        std::vector<byte> key(32), text(65536 + 67);
+        uint32_t seed = 1;
+        auto rand8 = [&seed] { return static_cast<byte>((seed = seed * 1664525u + 1013904223u) >> 24); };
+        std::generate(key.begin(), key.end(), rand8);
+        std::generate(text.begin(), text.end(), rand8);
+        const auto r = reinterpret_cast<const poly1305::key_r*>(key.data() + 0);
+        const auto s = reinterpret_cast<const poly1305::key_s*>(key.data() + 16);
+
+        std::vector<size_t> lengths;
+        for (size_t len = 0; len <= 1100; len++) lengths.push_back(len);
+        for (size_t len : {4096, 4096 + 7, 65536 + 67}) lengths.push_back(len);
+
+        for (size_t len : lengths)
+        {
+            const auto expected = poly1305::common::impl::calculate_poly1305<poly1305::x86::poly1305_tag_context>(r, s, text.data(), len);
+            if (poly1305::x64::calculate_poly1305(r, s, text.data(), len) != expected)
+            {
+                std::cerr << "TEST(" << poly1305::x64::backend_name() << ") [length " << len << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+
+            if (poly1305::x86::calculate_poly1305(r, s, text.data(), len) != expected)
+            {
+                std::cerr << "TEST(" << poly1305::x86::backend_name() << ") [length " << len << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+
+            auto ctx86 = poly1305::x86::prepare_poly1305_tag_context(r, s);
+            poly1305::common::impl::process_bytes(poly1305::x86::impl::process_blocks_interleaved, ctx86, text.data(), len);
+            if (poly1305::x86::finalize_and_get_mac(ctx86) != expected)
+            {
+                std::cerr << "TEST(x86-interleaved) [length " << len << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+
+            auto ctx64 = poly1305::x64::prepare_poly1305_tag_context(r, s);
+            poly1305::common::impl::process_bytes(poly1305::x64::impl::process_blocks_interleaved, ctx64, text.data(), len);
+            if (poly1305::x64::finalize_and_get_mac(ctx64) != expected)
+            {
+                std::cerr << "TEST(x64-interleaved) [length " << len << "] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+
+            auto ctx = poly1305::x64::prepare_poly1305_tag_context(r, s);
+            for (size_t i = 0, chunk = 1; i < len; i += chunk, chunk = chunk * 3 + 5)
+                poly1305::x64::process_bytes(ctx, text.data() + i, std::min(chunk, len - i));
+            if (poly1305::x64::finalize_and_get_mac(ctx) != expected)
+            {
+                std::cerr << "TEST(" << poly1305::x64::backend_name() << ") [length " << len << ", chunked] FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+    }
+
+    // parallel: same as single-threaded, from block-aligned and unaligned starts.
+    {
+        std::vector<byte> key(32), text(3 * 1024 * 1024 + 100);
+        for (size_t i = 0; i < key.size(); i++) key[i] = static_cast<byte>(i * 3 + 7);
+        for (size_t i = 0; i < text.size(); i++) text[i] = static_cast<byte>(i * 31 + 3);
+        const auto r = reinterpret_cast<const poly1305::key_r*>(key.data() + 0);
+        const auto s = reinterpret_cast<const poly1305::key_s*>(key.data() + 16);
+
+        poly1305::parallel::thread_pool pool{3};
+        for (size_t prefix : {size_t{0}, size_t{5}, size_t{16}})
+        {
+            for (size_t length : {size_t{1000}, size_t{1024 * 1024}, text.size() - prefix})
+            {
+                auto expected_ctx = poly1305::prepare_poly1305_tag_context(r, s);
+                poly1305::process_bytes(expected_ctx, text.data(), prefix + length);
+                const auto expected = poly1305::finalize_and_get_mac(expected_ctx);
+
+                auto ctx = poly1305::prepare_poly1305_tag_context(r, s);
+                poly1305::process_bytes(ctx, text.data(), prefix);
+                poly1305::parallel::process_bytes(ctx, text.data() + prefix, length, pool);
+                if (poly1305::finalize_and_get_mac(ctx) != expected)
+                {
+                    std::cerr << "TEST(parallel) [prefix " << prefix << ", length " << length << "] FAILED" << "\n";
+                    all_test_is_passed = false;
+                }
+            }
+        }
+
+        if (poly1305::parallel::calculate_poly1305(r, s, text.data(), text.size(), pool) != poly1305::calculate_poly1305(r, s, text.data(), text.size()))
+        {
+            std::cerr << "TEST(parallel) [one-shot] FAILED" << "\n";
+            all_test_is_passed = false;
+        }
+    }
+
+    // batch: same as one by one, for messages of various lengths with own keys.
+    {
+        constexpr size_t count = 67;
+        std::vector<byte> keys(32 * count), text(4096);
+        uint32_t seed = 7;
+        auto rand8 = [&seed] { return static_cast<byte>((seed = seed * 1664525u + 1013904223u) >> 24); };
+        std::generate(keys.begin(), keys.end(), rand8);
+        std::generate(text.begin(), text.end(), rand8);
+
+        std::vector<poly1305::tag_job> jobs;
+        std::vector<poly1305::mac> expected;
+        for (size_t i = 0; i < count; i++)
+        {
+            const auto r = reinterpret_cast<const poly1305::key_r*>(keys.data() + 32 * i + 0);
+            const auto s = reinterpret_cast<const poly1305::key_s*>(keys.data() + 32 * i + 16);
+            const size_t length = i % 11 == 10 ? 2048 + i : i * 37 % 600;
+            jobs.push_back({r, s, text.data() + i, length});
+            expected.push_back(poly1305::common::impl::calculate_poly1305<poly1305::x86::poly1305_tag_context>(r, s, text.data() + i, length));
+        }
+
+        for (auto calculate_poly1305_tags : {poly1305::x86::calculate_poly1305_tags, poly1305::x64::calculate_poly1305_tags})
+        {
+            std::vector<poly1305::mac> macs(count);
+            calculate_poly1305_tags(jobs.data(), count, macs.data());
+            if (!poly1305::verify_poly1305_tags(macs.data(), expected.data(), count))
+            {
+                std::cerr << "TEST(batch) FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+
+            // verify_poly1305_tags reports each mismatch.
+            macs[3][15] ^= 1;
+            std::array<bool, count> results{};
+            if (poly1305::verify_poly1305_tags(macs.data(), expected.data(), count, results.data()) ||
+                std::count(results.begin(), results.end(), true) != count - 1 || results[3])
+            {
+                std::cerr << "TEST(batch verify) FAILED" << "\n";
+                all_test_is_passed = false;
+            }
+        }
+    }
+
     return all_test_is_passed ? 0 : 1;
 }